@@ -1,108 +1,1555 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-const int P = 5; // Number of processes
-const int R = 3; // Number of resource types
+enum class RequestResult {
+    Granted,
+    ExceedsClaim, // request > need
+    MustWait,     // request > available
+    Unsafe,       // granting would leave the system unsafe
+    TimedOut      // ResourceManager gave up waiting
+};
 
-// Function to check if the system is in a safe state
-bool isSafe(std::vector<int> available, std::vector<std::vector<int>> max, std::vector<std::vector<int>> allocation) {
-    std::vector<std::vector<int>> need(P, std::vector<int>(R));
-    for (int i = 0; i < P; i++) {
+// True if a[j] <= b[j] for every j < n: the need-vs-work and request
+// checks. Compares 8 resources per instruction with AVX2 (build with -mavx2
+// or -march=native), 4 with SSE2, and finishes any tail without branching
+// per element.
+inline bool fitsWithin(const int* a, const int* b, int n) {
+    int j = 0;
+#if defined(__AVX2__)
+    for (; j + 8 <= n; j += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i over = _mm256_cmpgt_epi32(x, y);
+        if (!_mm256_testz_si256(over, over)) return false;
+    }
+#endif
+#if defined(__SSE2__)
+    for (; j + 4 <= n; j += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi32(x, y))) return false;
+    }
+#endif
+    int over = 0;
+    for (; j < n; j++) over |= a[j] > b[j];
+    return !over;
+}
+
+// Compile-time row length: small rows are compared in one fully unrolled,
+// branch-free pass; longer ones keep the per-vector early exit
+template <int N>
+inline bool fitsWithin(const int* a, const int* b) {
+    if (N > 8) return fitsWithin(a, b, N);
+    int over = 0;
+    for (int j = 0; j < N; j++) over |= a[j] > b[j];
+    return !over;
+}
+
+enum class SafetyAlgorithm {
+    Scan,  // classic O(P^2 * R) rescans
+    Sorted // per-resource need order, roughly O(P * R * log P)
+};
+
+// Banker's algorithm state for P processes and R resource types, sized at
+// runtime. Matrices are contiguous and row-major (row p holds process p),
+// need is kept equal to max - allocation as allocations change, and all
+// scratch space is allocated once, so checks and requests never touch the heap.
+class BankerState {
+private:
+    int P; // Number of processes
+    int R; // Number of resource types
+    std::vector<int> available;
+    std::vector<int> maxClaim;
+    std::vector<int> allocation;
+    std::vector<int> need;
+
+    SafetyAlgorithm algorithm = SafetyAlgorithm::Scan;
+
+    // Scratch for isSafe()
+    std::vector<int> work;
+    std::vector<char> finish;
+    std::vector<int> safeSeq;
+
+    // For isSafeSorted(): row j of byNeed lists processes by ascending
+    // need[p][j] and rank[j * P + p] is p's position in that row. Both are
+    // kept current as need changes.
+    std::vector<int> byNeed;
+    std::vector<int> rank;
+    std::vector<int> cursor;  // per resource, first process not yet counted
+    std::vector<int> blocked; // per process, resources still short
+    std::vector<int> ready;
+
+    void buildNeedOrder() {
         for (int j = 0; j < R; j++) {
-            need[i][j] = max[i][j] - allocation[i][j];
+            int* row = &byNeed[static_cast<size_t>(j) * P];
+            std::iota(row, row + P, 0);
+            std::sort(row, row + P, [&](int a, int b) { return need[a * R + j] < need[b * R + j]; });
+            for (int k = 0; k < P; k++) rank[static_cast<size_t>(j) * P + row[k]] = k;
         }
     }
 
-    std::vector<bool> finish(P, false);
-    std::vector<int> safeSeq;
-    std::vector<int> work = available;
+    // Restores the order of p in every resource row after need[p] changed
+    void reorderNeed(int p) {
+        for (int j = 0; j < R; j++) {
+            int* row = &byNeed[static_cast<size_t>(j) * P];
+            int* rankJ = &rank[static_cast<size_t>(j) * P];
+            int value = need[p * R + j];
+            int k = rankJ[p];
+            while (k > 0 && need[row[k - 1] * R + j] > value) {
+                row[k] = row[k - 1];
+                rankJ[row[k]] = k;
+                k--;
+            }
+            while (k < P - 1 && need[row[k + 1] * R + j] < value) {
+                row[k] = row[k + 1];
+                rankJ[row[k]] = k;
+                k++;
+            }
+            row[k] = p;
+            rankJ[p] = k;
+        }
+    }
 
-    int count = 0;
-    while (count < P) {
-        bool found = false;
-        for (int p = 0; p < P; p++) {
-            if (!finish[p]) {
-                int j;
-                for (j = 0; j < R; j++) {
-                    if (need[p][j] > work[j]) {
-                        break;
+    // Moves resource j's cursor past every process whose need now fits
+    void advance(int j) {
+        const int* row = &byNeed[static_cast<size_t>(j) * P];
+        while (cursor[j] < P && need[row[cursor[j]] * R + j] <= work[j]) {
+            int p = row[cursor[j]++];
+            if (--blocked[p] == 0) ready.push_back(p);
+        }
+    }
+
+    bool safetyCheck() {
+        return algorithm == SafetyAlgorithm::Sorted ? isSafeSorted() : isSafe();
+    }
+
+    // Safety algorithm on the current state, judging need against work
+    // with fits(need, work, R)
+    template <typename Fits>
+    bool scanSafe(Fits fits) {
+        std::fill(finish.begin(), finish.end(), 0);
+        safeSeq.clear();
+        work = available;
+
+        int count = 0;
+        while (count < P) {
+            bool found = false;
+            for (int p = 0; p < P; p++) {
+                if (!finish[p]) {
+                    if (fits(needRow(p), work.data(), R)) {
+                        const int* allocP = allocationRow(p);
+                        for (int k = 0; k < R; k++) {
+                            work[k] += allocP[k];
+                        }
+                        safeSeq.push_back(p);
+                        finish[p] = 1;
+                        found = true;
+                        count++;
                     }
                 }
-                if (j == R) {
+            }
+            if (!found) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    BankerState(int processes, int resources)
+        : P(processes), R(resources), available(resources, 0),
+          maxClaim(static_cast<size_t>(processes) * resources, 0),
+          allocation(static_cast<size_t>(processes) * resources, 0),
+          need(static_cast<size_t>(processes) * resources, 0),
+          work(resources), finish(processes),
+          byNeed(static_cast<size_t>(processes) * resources),
+          rank(static_cast<size_t>(processes) * resources),
+          cursor(resources), blocked(processes) {
+        safeSeq.reserve(processes);
+        ready.reserve(processes);
+        buildNeedOrder();
+    }
+
+    BankerState(const std::vector<int>& avail, const std::vector<std::vector<int>>& max,
+                const std::vector<std::vector<int>>& alloc)
+        : BankerState(static_cast<int>(max.size()), static_cast<int>(avail.size())) {
+        available = avail;
+        for (int i = 0; i < P; i++) {
+            for (int j = 0; j < R; j++) {
+                maxClaim[i * R + j] = max[i][j];
+                allocation[i * R + j] = alloc[i][j];
+                need[i * R + j] = max[i][j] - alloc[i][j];
+            }
+        }
+        buildNeedOrder();
+    }
+
+    // Algorithm request() uses to judge the trial state
+    void setSafetyAlgorithm(SafetyAlgorithm a) { algorithm = a; }
+
+    int processes() const { return P; }
+    int resources() const { return R; }
+    const int* availableRow() const { return available.data(); }
+    const int* maxRow(int p) const { return &maxClaim[static_cast<size_t>(p) * R]; }
+    const int* allocationRow(int p) const { return &allocation[static_cast<size_t>(p) * R]; }
+    const int* needRow(int p) const { return &need[static_cast<size_t>(p) * R]; }
+
+    // Safe sequence found by the last successful isSafe()
+    const std::vector<int>& safeSequence() const { return safeSeq; }
+
+    // Safety algorithm on the current state
+    bool isSafe() {
+        return scanSafe([](const int* a, const int* b, int n) { return fitsWithin(a, b, n); });
+    }
+
+    // isSafe() with the original element-at-a-time compare that stops at
+    // the first short resource; the scalar baseline for the kernel benchmark
+    bool isSafeScalar() {
+        return scanSafe([](const int* a, const int* b, int n) {
+            for (int j = 0; j < n; j++) {
+                if (a[j] > b[j]) return false;
+            }
+            return true;
+        });
+    }
+
+    // Scratch space for wouldBeSafe(), one per thread
+    struct TrialScratch {
+        std::vector<int> work;
+        std::vector<char> finish;
+        std::vector<int> needP;
+        std::vector<int> allocP;
+    };
+
+    // Verdict of request() without changing anything, so many candidates
+    // can be screened against the same state concurrently
+    RequestResult wouldBeSafe(int processId, const std::vector<int>& req, TrialScratch& s) const {
+        if (!fitsWithin(req.data(), needRow(processId), R)) return RequestResult::ExceedsClaim;
+        if (!fitsWithin(req.data(), available.data(), R)) return RequestResult::MustWait;
+
+        s.work.resize(R);
+        s.needP.resize(R);
+        s.allocP.resize(R);
+        s.finish.assign(P, 0);
+        for (int j = 0; j < R; j++) {
+            s.work[j] = available[j] - req[j];
+            s.needP[j] = needRow(processId)[j] - req[j];
+            s.allocP[j] = allocationRow(processId)[j] + req[j];
+        }
+
+        int count = 0;
+        while (count < P) {
+            bool found = false;
+            for (int p = 0; p < P; p++) {
+                const int* needQ = p == processId ? s.needP.data() : needRow(p);
+                if (!s.finish[p] && fitsWithin(needQ, s.work.data(), R)) {
+                    const int* allocQ = p == processId ? s.allocP.data() : allocationRow(p);
                     for (int k = 0; k < R; k++) {
+                        s.work[k] += allocQ[k];
+                    }
+                    s.finish[p] = 1;
+                    found = true;
+                    count++;
+                }
+            }
+            if (!found) {
+                return RequestResult::Unsafe;
+            }
+        }
+        return RequestResult::Granted;
+    }
+
+    // True if every process can finish in the order given by seq
+    bool followsSequence(const std::vector<int>& seq) {
+        if (static_cast<int>(seq.size()) != P) return false;
+        work = available;
+        for (int p : seq) {
+            if (!fitsWithin(needRow(p), work.data(), R)) return false;
+            const int* allocP = allocationRow(p);
+            for (int k = 0; k < R; k++) {
+                work[k] += allocP[k];
+            }
+        }
+        return true;
+    }
+
+    // Same verdict as isSafe() without rescanning unfinished processes.
+    // blocked[p] counts resources whose need exceeds work; each resource's
+    // cursor walks its need order once, so as work grows only processes that
+    // just became satisfiable are visited. Any satisfiable process may go
+    // next (work only grows), so the order they finish in does not matter.
+    bool isSafeSorted() {
+        safeSeq.clear();
+        ready.clear();
+        work = available;
+        std::fill(blocked.begin(), blocked.end(), R);
+        std::fill(cursor.begin(), cursor.end(), 0);
+        if (R == 0) {
+            for (int p = 0; p < P; p++) ready.push_back(p);
+        }
+        for (int j = 0; j < R; j++) advance(j);
+
+        while (!ready.empty()) {
+            int p = ready.back();
+            ready.pop_back();
+            safeSeq.push_back(p);
+            const int* allocP = allocationRow(p);
+            for (int j = 0; j < R; j++) {
+                if (allocP[j] > 0) {
+                    work[j] += allocP[j];
+                    advance(j);
+                }
+            }
+        }
+        return static_cast<int>(safeSeq.size()) == P;
+    }
+
+    // Resource-Request Algorithm. The request is applied in place and
+    // rolled back if the resulting state is unsafe.
+    RequestResult request(int processId, const std::vector<int>& req) {
+        int* needP = &need[static_cast<size_t>(processId) * R];
+        int* allocP = &allocation[static_cast<size_t>(processId) * R];
+
+        // 1. Check if request <= need
+        if (!fitsWithin(req.data(), needP, R)) {
+            return RequestResult::ExceedsClaim;
+        }
+
+        // 2. Check if request <= available
+        if (!fitsWithin(req.data(), available.data(), R)) {
+            return RequestResult::MustWait;
+        }
+
+        // 3. Pretend to allocate resources
+        for (int i = 0; i < R; i++) {
+            available[i] -= req[i];
+            allocP[i] += req[i];
+            needP[i] -= req[i];
+        }
+        reorderNeed(processId);
+
+        // 4. Run safety algorithm on the new state; undo if unsafe
+        if (safetyCheck()) {
+            return RequestResult::Granted;
+        }
+        for (int i = 0; i < R; i++) {
+            available[i] += req[i];
+            allocP[i] -= req[i];
+            needP[i] += req[i];
+        }
+        reorderNeed(processId);
+        return RequestResult::Unsafe;
+    }
+
+    // request() that first tries to reuse knownSafe, a safe sequence of the
+    // state before this request: if it still works after the trial
+    // allocation, that is an O(P * R) check instead of a full search. On a
+    // full search knownSafe is replaced by the new safe sequence.
+    RequestResult request(int processId, const std::vector<int>& req, std::vector<int>& knownSafe) {
+        int* needP = &need[static_cast<size_t>(processId) * R];
+        int* allocP = &allocation[static_cast<size_t>(processId) * R];
+        if (!fitsWithin(req.data(), needP, R)) {
+            return RequestResult::ExceedsClaim;
+        }
+        if (!fitsWithin(req.data(), available.data(), R)) {
+            return RequestResult::MustWait;
+        }
+        for (int i = 0; i < R; i++) {
+            available[i] -= req[i];
+            allocP[i] += req[i];
+            needP[i] -= req[i];
+        }
+        reorderNeed(processId);
+
+        if (followsSequence(knownSafe)) {
+            return RequestResult::Granted;
+        }
+        if (safetyCheck()) {
+            knownSafe = safeSeq;
+            return RequestResult::Granted;
+        }
+        for (int i = 0; i < R; i++) {
+            available[i] += req[i];
+            allocP[i] -= req[i];
+            needP[i] += req[i];
+        }
+        reorderNeed(processId);
+        return RequestResult::Unsafe;
+    }
+
+    // Returns resources to the pool; false (and no change) if processId
+    // does not hold all of them
+    bool release(int processId, const std::vector<int>& rel) {
+        int* needP = &need[static_cast<size_t>(processId) * R];
+        int* allocP = &allocation[static_cast<size_t>(processId) * R];
+        if (!fitsWithin(rel.data(), allocP, R)) {
+            return false;
+        }
+        for (int i = 0; i < R; i++) {
+            available[i] += rel[i];
+            allocP[i] -= rel[i];
+            needP[i] += rel[i];
+        }
+        reorderNeed(processId);
+        return true;
+    }
+};
+
+// BankerState for a resource count known at compile time. Rows are
+// std::array<int, NR>, so every per-row loop has a constant trip count and
+// fully unrolls for the common small-R cases.
+template <int NR>
+class FixedBankerState {
+private:
+    using Row = std::array<int, NR>;
+
+    int P;
+    Row available;
+    std::vector<Row> maxClaim;
+    std::vector<Row> allocation;
+    std::vector<Row> need;
+
+    // Scratch for isSafe()
+    Row work;
+    std::vector<char> finish;
+    std::vector<int> safeSeq;
+
+public:
+    explicit FixedBankerState(const BankerState& state)
+        : P(state.processes()), maxClaim(P), allocation(P), need(P), finish(P) {
+        if (state.resources() != NR) {
+            throw std::invalid_argument("FixedBankerState<" + std::to_string(NR) + "> built from a state with " +
+                                        std::to_string(state.resources()) + " resources");
+        }
+        for (int j = 0; j < NR; j++) available[j] = state.availableRow()[j];
+        for (int i = 0; i < P; i++) {
+            for (int j = 0; j < NR; j++) {
+                maxClaim[i][j] = state.maxRow(i)[j];
+                allocation[i][j] = state.allocationRow(i)[j];
+                need[i][j] = state.needRow(i)[j];
+            }
+        }
+        safeSeq.reserve(P);
+    }
+
+    const std::vector<int>& safeSequence() const { return safeSeq; }
+
+    bool isSafe() {
+        std::fill(finish.begin(), finish.end(), 0);
+        safeSeq.clear();
+        work = available;
+
+        int count = 0;
+        while (count < P) {
+            bool found = false;
+            for (int p = 0; p < P; p++) {
+                if (!finish[p] && fitsWithin<NR>(need[p].data(), work.data())) {
+                    for (int k = 0; k < NR; k++) {
                         work[k] += allocation[p][k];
                     }
                     safeSeq.push_back(p);
-                    finish[p] = true;
+                    finish[p] = 1;
                     found = true;
                     count++;
                 }
             }
+            if (!found) {
+                return false;
+            }
         }
-        if (!found) {
-            std::cout << "System is not in a safe state!\n";
-            return false;
+        return true;
+    }
+
+    RequestResult request(int processId, const Row& req) {
+        Row& needP = need[processId];
+        Row& allocP = allocation[processId];
+        if (!fitsWithin<NR>(req.data(), needP.data())) {
+            return RequestResult::ExceedsClaim;
+        }
+        if (!fitsWithin<NR>(req.data(), available.data())) {
+            return RequestResult::MustWait;
+        }
+        for (int i = 0; i < NR; i++) {
+            available[i] -= req[i];
+            allocP[i] += req[i];
+            needP[i] -= req[i];
+        }
+        if (isSafe()) {
+            return RequestResult::Granted;
         }
+        for (int i = 0; i < NR; i++) {
+            available[i] += req[i];
+            allocP[i] -= req[i];
+            needP[i] += req[i];
+        }
+        return RequestResult::Unsafe;
+    }
+};
+
+// Thread-safe admission controller over a BankerState. request() blocks
+// (optionally with a timeout) until the request can be granted safely;
+// release() returns resources. Each waiter sleeps on its own condition
+// variable and remembers the resource that blocked it, so a release only
+// re-checks waiters blocked on a resource it freed, or blocked by an unsafe
+// state, and hands the grant over directly instead of waking everyone.
+class ResourceManager {
+private:
+    struct Waiter {
+        int processId;
+        const std::vector<int>* request;
+        int blockedOn; // resource short at the last attempt, -1 if unsafe
+        bool granted = false;
+        std::condition_variable wake;
+
+        Waiter(int p, const std::vector<int>* req, int blocked)
+            : processId(p), request(req), blockedOn(blocked) {}
+    };
+
+    std::mutex lock;
+    BankerState state;
+    std::vector<int> total; // available + all allocations, for audit()
+    std::vector<Waiter*> waiting; // FIFO
+
+    int shortResource(const std::vector<int>& req) const {
+        const int* available = state.availableRow();
+        for (int j = 0; j < state.resources(); j++) {
+            if (req[j] > available[j]) return j;
+        }
+        return -1;
+    }
+
+    // Retries waiters a release could have unblocked, oldest first
+    void grantWaiters(const std::vector<int>& released) {
+        for (size_t i = 0; i < waiting.size();) {
+            Waiter* w = waiting[i];
+            if (w->blockedOn >= 0 && released[w->blockedOn] == 0) {
+                i++;
+                continue;
+            }
+            RequestResult result = state.request(w->processId, *w->request);
+            if (result == RequestResult::Granted) {
+                w->granted = true;
+                waiting.erase(waiting.begin() + i);
+                w->wake.notify_one();
+            } else {
+                w->blockedOn = result == RequestResult::MustWait ? shortResource(*w->request) : -1;
+                i++;
+            }
+        }
+    }
+
+public:
+    explicit ResourceManager(BankerState initial) : state(std::move(initial)), total(state.resources()) {
+        for (int j = 0; j < state.resources(); j++) {
+            total[j] = state.availableRow()[j];
+            for (int p = 0; p < state.processes(); p++) total[j] += state.allocationRow(p)[j];
+        }
+    }
+
+    // Returns Granted, ExceedsClaim (never waits) or TimedOut
+    RequestResult request(int processId, const std::vector<int>& req,
+                          std::chrono::steady_clock::duration timeout = std::chrono::steady_clock::duration::max()) {
+        std::unique_lock<std::mutex> guard(lock);
+        RequestResult result = state.request(processId, req);
+        if (result == RequestResult::Granted || result == RequestResult::ExceedsClaim) {
+            return result;
+        }
+
+        Waiter self(processId, &req, result == RequestResult::MustWait ? shortResource(req) : -1);
+        waiting.push_back(&self);
+        auto deadline = timeout == std::chrono::steady_clock::duration::max()
+                            ? std::chrono::steady_clock::time_point::max()
+                            : std::chrono::steady_clock::now() + timeout;
+        while (!self.granted) {
+            if (self.wake.wait_until(guard, deadline) == std::cv_status::timeout && !self.granted) {
+                waiting.erase(std::find(waiting.begin(), waiting.end(), &self));
+                return RequestResult::TimedOut;
+            }
+        }
+        return RequestResult::Granted;
+    }
+
+    // Returns resources held by processId; false if it does not hold them
+    bool release(int processId, const std::vector<int>& rel) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!state.release(processId, rel)) return false;
+        grantWaiters(rel);
+        return true;
+    }
+
+    std::vector<int> allocationOf(int processId) {
+        std::lock_guard<std::mutex> guard(lock);
+        const int* row = state.allocationRow(processId);
+        return std::vector<int>(row, row + state.resources());
+    }
+
+    std::vector<int> needOf(int processId) {
+        std::lock_guard<std::mutex> guard(lock);
+        const int* row = state.needRow(processId);
+        return std::vector<int>(row, row + state.resources());
+    }
+
+    // Invariants: the state is safe, nothing is over-allocated, and no
+    // resource units were created or lost
+    bool audit() {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int j = 0; j < state.resources(); j++) {
+            int sum = state.availableRow()[j];
+            if (sum < 0) return false;
+            for (int p = 0; p < state.processes(); p++) {
+                if (state.allocationRow(p)[j] < 0 || state.needRow(p)[j] < 0) return false;
+                sum += state.allocationRow(p)[j];
+            }
+            if (sum != total[j]) return false;
+        }
+        return state.isSafe();
+    }
+};
+
+// Minimal fixed-size thread pool for batch admission
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::vector<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable hasWork;
+    std::condition_variable idle;
+    size_t running = 0;
+    bool stopping = false;
+
+public:
+    explicit ThreadPool(int threads) {
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([this] {
+                std::unique_lock<std::mutex> guard(lock);
+                while (true) {
+                    hasWork.wait(guard, [this] { return stopping || !tasks.empty(); });
+                    if (tasks.empty()) return;
+                    std::function<void()> task = std::move(tasks.back());
+                    tasks.pop_back();
+                    running++;
+                    guard.unlock();
+                    task();
+                    guard.lock();
+                    running--;
+                    if (tasks.empty() && running == 0) idle.notify_all();
+                }
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        hasWork.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    int size() const {
+        return static_cast<int>(workers.size());
+    }
+
+    // Runs fn(begin, end) over [0, count) split into one chunk per worker
+    // and waits for all of them
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn) {
+        size_t chunks = std::min<size_t>(workers.size(), count);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (size_t c = 0; c < chunks; c++) {
+                size_t begin = count * c / chunks;
+                size_t end = count * (c + 1) / chunks;
+                tasks.push_back([&fn, begin, end] { fn(begin, end); });
+            }
+        }
+        hasWork.notify_all();
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this] { return tasks.empty() && running == 0; });
+    }
+};
+
+struct PendingRequest {
+    int processId;
+    std::vector<int> request;
+    int priority = 0; // higher goes first under BatchOrder::Priority
+};
+
+enum class BatchOrder {
+    FIFO,          // as submitted
+    SmallestFirst, // fewest total units first
+    Priority       // highest priority first, FIFO among equals
+};
+
+struct BatchResult {
+    std::vector<size_t> granted;         // indices into the batch, in grant order
+    std::vector<size_t> deferred;        // indices left waiting or rejected
+    std::vector<RequestResult> outcome;  // per request
+};
+
+// Greedily grants a maximal safe subset of pending in the chosen order.
+// A granted request never makes a later one safe or available again, so
+// one pass is enough and the result is maximal for that order. Each trial
+// first re-validates the last safe sequence and only searches anew when
+// that fails. With a pool, every candidate is screened concurrently
+// against the starting state first; anything unsafe or unavailable there
+// stays so after further grants, so only survivors go through the
+// sequential pass and the result is the same as without the pool.
+BatchResult admitBatch(BankerState& state, const std::vector<PendingRequest>& pending,
+                       BatchOrder order, ThreadPool* pool = nullptr) {
+    BatchResult result;
+    result.outcome.assign(pending.size(), RequestResult::Unsafe);
+
+    std::vector<size_t> order_(pending.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    if (order == BatchOrder::SmallestFirst) {
+        std::vector<long> units(pending.size(), 0);
+        for (size_t i = 0; i < pending.size(); i++) {
+            for (int r : pending[i].request) units[i] += r;
+        }
+        std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) { return units[a] < units[b]; });
+    } else if (order == BatchOrder::Priority) {
+        std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) {
+            return pending[a].priority > pending[b].priority;
+        });
+    }
+
+    std::vector<char> screenedOut(pending.size(), 0);
+    if (pool && pool->size() > 1) {
+        pool->parallelFor(pending.size(), [&](size_t begin, size_t end) {
+            BankerState::TrialScratch scratch;
+            for (size_t i = begin; i < end; i++) {
+                RequestResult r = state.wouldBeSafe(pending[i].processId, pending[i].request, scratch);
+                if (r != RequestResult::Granted) {
+                    result.outcome[i] = r;
+                    screenedOut[i] = 1;
+                }
+            }
+        });
+    }
+
+    std::vector<int> knownSafe;
+    if (state.isSafe()) knownSafe = state.safeSequence();
+    for (size_t i : order_) {
+        if (screenedOut[i]) {
+            result.deferred.push_back(i);
+            continue;
+        }
+        result.outcome[i] = state.request(pending[i].processId, pending[i].request, knownSafe);
+        if (result.outcome[i] == RequestResult::Granted) {
+            result.granted.push_back(i);
+        } else {
+            result.deferred.push_back(i);
+        }
+    }
+    return result;
+}
+
+// Deadlock detection for systems without declared maximum claims. Tracks
+// available, allocation and outstanding request matrices (row-major, like
+// BankerState) under request/release events: a request is granted at once
+// if it fits in available and otherwise the process blocks until a release
+// lets it through.
+//
+// detect() is the classic multi-instance detection algorithm over every
+// process. The incremental mode keeps a wait-for graph implicitly, as
+// per-resource lists of holders and of requesters: p waits for q while p
+// requests more of some resource than is available and q holds some of it.
+// A blocked request can only deadlock processes that (transitively) wait
+// for the requester, and whether they finish depends only on what they
+// wait for, so only that closure is reduced. Releases by live processes
+// never resolve a deadlock, and aborting a victim only affects the closure
+// of the current deadlocked set.
+class DeadlockDetector {
+private:
+    int P;
+    int R;
+    std::vector<int> available;
+    std::vector<int> allocation;
+    std::vector<int> requested; // outstanding, non-zero only while blocked
+    std::vector<char> blocked;
+
+    // Wait-for graph: holders[j] / wanting[j] list processes with
+    // allocation / outstanding request of resource j; *Pos gives the index
+    // of process p in those lists for O(1) removal
+    std::vector<std::vector<int>> holders;
+    std::vector<std::vector<int>> wanting;
+    std::vector<int> holderPos;
+    std::vector<int> wantingPos;
+
+    std::vector<char> deadlocked;
+    std::vector<int> deadlockedSet;
+
+    // Scratch for closures and reductions
+    std::vector<char> inSet;
+    std::vector<char> resourceSeen;
+    std::vector<int> members;
+    std::vector<int> candidates;
+    std::vector<int> work;
+    std::vector<char> finish;
+
+    void setAllocation(int p, int j, int value) {
+        size_t slot = static_cast<size_t>(p) * R + j;
+        allocation[slot] = value;
+        track(holders[j], holderPos, p, j, value > 0);
     }
 
+    void setRequested(int p, int j, int value) {
+        size_t slot = static_cast<size_t>(p) * R + j;
+        requested[slot] = value;
+        track(wanting[j], wantingPos, p, j, value > 0);
+    }
+
+    void track(std::vector<int>& list, std::vector<int>& pos, int p, int j, bool present) {
+        size_t slot = static_cast<size_t>(p) * R + j;
+        if (present && pos[slot] < 0) {
+            pos[slot] = static_cast<int>(list.size());
+            list.push_back(p);
+        } else if (!present && pos[slot] >= 0) {
+            int last = list.back();
+            list[pos[slot]] = last;
+            pos[static_cast<size_t>(last) * R + j] = pos[slot];
+            list.pop_back();
+            pos[slot] = -1;
+        }
+    }
+
+    bool waitsOn(int p, int j) const {
+        return requested[static_cast<size_t>(p) * R + j] > available[j];
+    }
+
+    void addMember(int p) {
+        if (!inSet[p]) {
+            inSet[p] = 1;
+            members.push_back(p);
+        }
+    }
+
+    // Adds everything that transitively waits for members already present.
+    // Each resource's requester list is walked at most once.
+    void addWaitersClosure() {
+        std::fill(resourceSeen.begin(), resourceSeen.end(), 0);
+        for (size_t i = 0; i < members.size(); i++) {
+            int q = members[i];
+            for (int j = 0; j < R; j++) {
+                if (resourceSeen[j] || allocation[static_cast<size_t>(q) * R + j] == 0) continue;
+                resourceSeen[j] = 1;
+                for (int p : wanting[j]) {
+                    if (waitsOn(p, j)) addMember(p);
+                }
+            }
+        }
+    }
+
+    // Adds everything members transitively wait for
+    void addWaitedOnClosure() {
+        std::fill(resourceSeen.begin(), resourceSeen.end(), 0);
+        for (size_t i = 0; i < members.size(); i++) {
+            int p = members[i];
+            if (!blocked[p]) continue;
+            for (int j = 0; j < R; j++) {
+                if (resourceSeen[j] || !waitsOn(p, j)) continue;
+                resourceSeen[j] = 1;
+                for (int q : holders[j]) addMember(q);
+            }
+        }
+    }
+
+    // Detection reduction over members; unfinished members are deadlocked
+    void reduceMembers() {
+        work = available;
+        for (int p : members) {
+            const int* allocP = allocationRow(p);
+            finish[p] = std::all_of(allocP, allocP + R, [](int a) { return a == 0; });
+        }
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (int p : members) {
+                if (finish[p]) continue;
+                if (fitsWithin(&requested[static_cast<size_t>(p) * R], work.data(), R)) {
+                    const int* allocP = &allocation[static_cast<size_t>(p) * R];
+                    for (int k = 0; k < R; k++) {
+                        work[k] += allocP[k];
+                    }
+                    finish[p] = 1;
+                    progress = true;
+                }
+            }
+        }
+        // Keep deadlockedSet sorted without scanning every process
+        bool changed = false;
+        for (int p : members) {
+            if (deadlocked[p] == !finish[p]) continue;
+            deadlocked[p] = !finish[p];
+            if (deadlocked[p]) deadlockedSet.push_back(p);
+            changed = true;
+        }
+        if (changed) {
+            deadlockedSet.erase(std::remove_if(deadlockedSet.begin(), deadlockedSet.end(),
+                                               [&](int p) { return !deadlocked[p]; }),
+                                deadlockedSet.end());
+            std::sort(deadlockedSet.begin(), deadlockedSet.end());
+        }
+    }
+
+    void clearMembers() {
+        for (int p : members) inSet[p] = 0;
+        members.clear();
+    }
+
+    void rebuildDeadlockedSet() {
+        deadlockedSet.clear();
+        for (int p = 0; p < P; p++) {
+            if (deadlocked[p]) deadlockedSet.push_back(p);
+        }
+    }
+
+    void grant(int p, const std::vector<int>& req) {
+        for (int j = 0; j < R; j++) {
+            available[j] -= req[j];
+            setAllocation(p, j, allocation[static_cast<size_t>(p) * R + j] + req[j]);
+        }
+    }
+
+    // After some of rel comes back, let blocked processes through in id
+    // order. Only those requesting a returned resource can newly fit.
+    void wakeBlocked(const int* rel) {
+        for (int j = 0; j < R; j++) {
+            if (rel[j] == 0) continue;
+            for (int p : wanting[j]) addMember(p);
+        }
+        candidates.assign(members.begin(), members.end());
+        clearMembers();
+        std::sort(candidates.begin(), candidates.end());
+        for (int p : candidates) {
+            const int* reqP = &requested[static_cast<size_t>(p) * R];
+            if (!fitsWithin(reqP, available.data(), R)) continue;
+            std::vector<int> req(reqP, reqP + R);
+            for (int j = 0; j < R; j++) setRequested(p, j, 0);
+            blocked[p] = 0;
+            grant(p, req);
+        }
+    }
+
+public:
+    bool incremental = true;
+
+    DeadlockDetector(int processes, const std::vector<int>& avail)
+        : P(processes), R(static_cast<int>(avail.size())), available(avail),
+          allocation(static_cast<size_t>(P) * R, 0), requested(static_cast<size_t>(P) * R, 0),
+          blocked(P, 0), holders(R), wanting(R),
+          holderPos(static_cast<size_t>(P) * R, -1), wantingPos(static_cast<size_t>(P) * R, -1),
+          deadlocked(P, 0), inSet(P, 0), resourceSeen(R, 0), work(R), finish(P, 0) {}
+
+    // Starts from a BankerState's allocation and available vectors
+    explicit DeadlockDetector(const BankerState& state)
+        : DeadlockDetector(state.processes(),
+                           std::vector<int>(state.availableRow(), state.availableRow() + state.resources())) {
+        for (int p = 0; p < P; p++) {
+            for (int j = 0; j < R; j++) setAllocation(p, j, state.allocationRow(p)[j]);
+        }
+    }
+
+    bool isBlocked(int p) const { return blocked[p]; }
+    const int* allocationRow(int p) const { return &allocation[static_cast<size_t>(p) * R]; }
+
+    // Returns true if granted immediately; otherwise p blocks and, in
+    // incremental mode, the affected part of the graph is re-examined
+    bool request(int p, const std::vector<int>& req) {
+        if (!blocked[p] && fitsWithin(req.data(), available.data(), R)) {
+            grant(p, req);
+            return true;
+        }
+        for (int j = 0; j < R; j++) {
+            setRequested(p, j, requested[static_cast<size_t>(p) * R + j] + req[j]);
+        }
+        blocked[p] = 1;
+        if (incremental) {
+            addMember(p);
+            addWaitersClosure();
+            addWaitedOnClosure();
+            reduceMembers();
+            clearMembers();
+        }
+        return false;
+    }
+
+    // Returns resources held by a running process, then wakes any blocked
+    // process that now fits. False if p is blocked or does not hold rel.
+    bool release(int p, const std::vector<int>& rel) {
+        if (blocked[p] || !fitsWithin(rel.data(), allocationRow(p), R)) return false;
+        for (int j = 0; j < R; j++) {
+            available[j] += rel[j];
+            setAllocation(p, j, allocation[static_cast<size_t>(p) * R + j] - rel[j]);
+        }
+        wakeBlocked(rel.data());
+        return true;
+    }
+
+    // Terminates p (the deadlock victim): drops its request and frees
+    // everything it holds. In incremental mode only the closure of the old
+    // deadlocked set is reduced again.
+    void abort(int p) {
+        std::vector<int> freed(allocationRow(p), allocationRow(p) + R);
+        for (int j = 0; j < R; j++) {
+            available[j] += freed[j];
+            setAllocation(p, j, 0);
+            setRequested(p, j, 0);
+        }
+        blocked[p] = 0;
+        if (deadlocked[p]) {
+            deadlocked[p] = 0;
+            deadlockedSet.erase(std::find(deadlockedSet.begin(), deadlockedSet.end(), p));
+            if (incremental) {
+                for (int q : deadlockedSet) addMember(q);
+                addWaitedOnClosure();
+                reduceMembers();
+                clearMembers();
+            }
+        }
+        wakeBlocked(freed.data());
+    }
+
+    // Full detection algorithm over all processes. Processes holding
+    // nothing cannot be part of a deadlock.
+    const std::vector<int>& detect() {
+        work = available;
+        for (int p = 0; p < P; p++) {
+            const int* allocP = allocationRow(p);
+            finish[p] = std::all_of(allocP, allocP + R, [](int a) { return a == 0; });
+        }
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (int p = 0; p < P; p++) {
+                if (!finish[p] && fitsWithin(&requested[static_cast<size_t>(p) * R], work.data(), R)) {
+                    const int* allocP = allocationRow(p);
+                    for (int k = 0; k < R; k++) {
+                        work[k] += allocP[k];
+                    }
+                    finish[p] = 1;
+                    progress = true;
+                }
+            }
+        }
+        for (int p = 0; p < P; p++) deadlocked[p] = !finish[p];
+        rebuildDeadlockedSet();
+        return deadlockedSet;
+    }
+
+    // Deadlocked processes as of the last examination
+    const std::vector<int>& deadlockedProcesses() const {
+        return deadlockedSet;
+    }
+
+    // The deadlocked process holding the most resource units, whose abort
+    // frees the most for the others; -1 if there is no deadlock
+    int suggestVictim() const {
+        int victim = -1;
+        long most = -1;
+        for (int p : deadlockedSet) {
+            const int* allocP = allocationRow(p);
+            long held = std::accumulate(allocP, allocP + R, 0L);
+            if (held > most) {
+                most = held;
+                victim = p;
+            }
+        }
+        return victim;
+    }
+};
+
+// Prints the verdict of the last safety check
+void printSafety(const BankerState& state, bool safe) {
+    if (!safe) {
+        std::cout << "System is not in a safe state!\n";
+        return;
+    }
+    const std::vector<int>& safeSeq = state.safeSequence();
     std::cout << "System is in a safe state.\nSafe sequence is: ";
-    for (int i = 0; i < P; i++) {
-        std::cout << "P" << safeSeq[i] << (i == P - 1 ? "" : " -> ");
+    for (size_t i = 0; i < safeSeq.size(); i++) {
+        std::cout << "P" << safeSeq[i] << (i == safeSeq.size() - 1 ? "" : " -> ");
     }
     std::cout << "\n";
-    return true;
 }
 
-// Resource-Request Algorithm
-void resourceRequest(int processId, std::vector<int> request, std::vector<int>& available, std::vector<std::vector<int>>& max, std::vector<std::vector<int>>& allocation) {
+// Runs one request against state and reports what happened
+void resourceRequest(BankerState& state, int processId, const std::vector<int>& request) {
     std::cout << "\n--- Processing Request from P" << processId << " for resources [ ";
     for(int r : request) std::cout << r << " ";
     std::cout << "] ---\n";
 
-    std::vector<std::vector<int>> need(P, std::vector<int>(R));
+    switch (state.request(processId, request)) {
+    case RequestResult::ExceedsClaim:
+        std::cout << "Error: Process has exceeded its maximum claim.\n";
+        break;
+    case RequestResult::MustWait:
+        std::cout << "Process must wait, resources not available.\n";
+        break;
+    case RequestResult::Granted:
+        printSafety(state, true);
+        std::cout << "Request granted!\n";
+        break;
+    case RequestResult::Unsafe:
+        printSafety(state, false);
+        std::cout << "Request denied as it leads to an unsafe state.\n";
+        break;
+    case RequestResult::TimedOut:
+        break;
+    }
+}
+
+// Random state for differential testing; small values keep it near the
+// safe/unsafe boundary
+BankerState randomState(std::mt19937& rng, int P, int R) {
+    std::uniform_int_distribution<int> small(0, 4);
+    std::vector<std::vector<int>> max(P, std::vector<int>(R));
+    std::vector<std::vector<int>> allocation(P, std::vector<int>(R));
+    std::vector<int> available(R);
+    for (int i = 0; i < P; i++) {
+        for (int j = 0; j < R; j++) {
+            allocation[i][j] = small(rng);
+            max[i][j] = allocation[i][j] + small(rng) * small(rng);
+        }
+    }
+    for (int j = 0; j < R; j++) available[j] = small(rng) * 2;
+    return BankerState(available, max, allocation);
+}
+
+// True if seq is a complete order in which every process can finish
+bool validSafeSequence(const BankerState& state, const std::vector<int>& seq) {
+    int P = state.processes();
+    int R = state.resources();
+    if (static_cast<int>(seq.size()) != P) return false;
+    std::vector<int> work(state.availableRow(), state.availableRow() + R);
+    std::vector<char> done(P, 0);
+    for (int p : seq) {
+        if (p < 0 || p >= P || done[p]) return false;
+        for (int j = 0; j < R; j++) {
+            if (state.needRow(p)[j] > work[j]) return false;
+        }
+        for (int j = 0; j < R; j++) work[j] += state.allocationRow(p)[j];
+        done[p] = 1;
+    }
+    return true;
+}
+
+// Randomized differential test of isSafeSorted() against isSafe(), both on
+// fresh states and after sequences of granted and rolled-back requests
+int verifySafetyAlgorithms(int rounds) {
+    std::mt19937 rng(2024);
+    int safeCount = 0;
+    int checks = 0;
+    for (int round = 0; round < rounds; round++) {
+        int P = 1 + rng() % 40;
+        int R = 1 + rng() % 6;
+        BankerState state = randomState(rng, P, R);
+        state.setSafetyAlgorithm(round % 2 ? SafetyAlgorithm::Sorted : SafetyAlgorithm::Scan);
+
+        for (int step = 0; step < 20; step++) {
+            bool expected = state.isSafeScalar();
+            bool kernel = state.isSafe();
+            bool actual = state.isSafeSorted();
+            bool fixed = expected;
+            if (R == 3) fixed = FixedBankerState<3>(state).isSafe();
+            if (R == 5) fixed = FixedBankerState<5>(state).isSafe();
+            checks++;
+            if (kernel != expected || fixed != expected) {
+                std::cout << "Mismatch in round " << round << " step " << step
+                          << ": vectorized or fixed-R isSafe() disagrees with the scalar check\n";
+                return 1;
+            }
+            if (expected != actual || (actual && !validSafeSequence(state, state.safeSequence()))) {
+                std::cout << "Mismatch in round " << round << " step " << step << ": isSafe() says "
+                          << expected << ", isSafeSorted() says " << actual << "\n";
+                return 1;
+            }
+            safeCount += expected;
+
+            int p = rng() % P;
+            std::vector<int> request(R);
+            for (int j = 0; j < R; j++) request[j] = std::min<int>(state.needRow(p)[j], rng() % 3);
+            state.request(p, request);
+        }
+    }
+    std::cout << "Verified " << checks << " states (" << safeCount << " safe, "
+              << checks - safeCount << " unsafe): scalar, vectorized, fixed-R and sorted verdicts match\n";
+    return 0;
+}
+
+// Safe state whose only safe order is P-1, P-2, ..., 0: each process needs
+// exactly what the one before it frees of resource 0 (or, with
+// randomBlocking, of one randomly chosen resource), so the scan finds one
+// process per pass over the table. bench keeps resource 0 so its workload
+// matches earlier runs; bench-kernel spreads the blocking resource so the
+// scalar compare cannot stop at the first element every time.
+BankerState chainState(int P, int R, unsigned seed, bool randomBlocking = false) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> unit(1, 3);
+    std::vector<std::vector<int>> max(P, std::vector<int>(R));
+    std::vector<std::vector<int>> allocation(P, std::vector<int>(R));
+    std::vector<int> available(R, 4);
+    std::vector<int> work = available;
+    for (int p = P - 1; p >= 0; p--) {
+        int blocking = randomBlocking ? static_cast<int>(rng() % R) : 0;
+        for (int j = 0; j < R; j++) {
+            int needJ = j == blocking ? work[j] : static_cast<int>(rng() % (work[j] + 1));
+            allocation[p][j] = unit(rng);
+            max[p][j] = allocation[p][j] + needJ;
+        }
+        for (int j = 0; j < R; j++) work[j] += allocation[p][j];
+    }
+    return BankerState(available, max, allocation);
+}
+
+template <typename Check>
+double timeChecks(Check check, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) check();
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+void benchmarkSafetyAlgorithms() {
+    const int R = 16;
+    std::cout << "Safety check on worst-case chain states, R = " << R << " (microseconds per check)\n";
+    std::cout << "       P        isSafe    isSafeSorted\n";
+    for (int P = 250; P <= 16000; P *= 2) {
+        BankerState state = chainState(P, R, P);
+        int repeats = std::max(1, 2000000 / P / (P / 250));
+        double scan = timeChecks([&] { state.isSafe(); }, std::max(1, repeats / 4));
+        double sorted = timeChecks([&] { state.isSafeSorted(); }, repeats);
+        std::cout << "  " << P << "\t" << scan << "\t" << sorted << "\n";
+    }
+}
+
+template <int NR>
+double timeFixedCheck(const BankerState& state, int repeats) {
+    FixedBankerState<NR> fixed(state);
+    return timeChecks([&] { fixed.isSafe(); }, repeats);
+}
+
+void benchmarkKernel() {
+    const int P = 1000;
+    const int resourceCounts[] = {4, 8, 16, 32, 64};
+#if defined(__AVX2__)
+    std::cout << "Kernel: AVX2\n";
+#elif defined(__SSE2__)
+    std::cout << "Kernel: SSE2 (build with -mavx2 for the 8-lane path)\n";
+#else
+    std::cout << "Kernel: scalar\n";
+#endif
+    std::cout << "isSafe() on worst-case chain states, P = " << P << " (microseconds per check)\n";
+    std::cout << "   R       scalar   vectorized   fixed-R\n";
+    for (int R : resourceCounts) {
+        BankerState state = chainState(P, R, R, true);
+        int repeats = 20;
+        double scalar = timeChecks([&] { state.isSafeScalar(); }, repeats);
+        double vectorized = timeChecks([&] { state.isSafe(); }, repeats);
+        double fixed = 0;
+        switch (R) {
+        case 4: fixed = timeFixedCheck<4>(state, repeats); break;
+        case 8: fixed = timeFixedCheck<8>(state, repeats); break;
+        case 16: fixed = timeFixedCheck<16>(state, repeats); break;
+        case 32: fixed = timeFixedCheck<32>(state, repeats); break;
+        case 64: fixed = timeFixedCheck<64>(state, repeats); break;
+        }
+        std::cout << "  " << R << "\t" << scalar << "\t" << vectorized << "\t" << fixed << "\n";
+    }
+}
+
+// Safe state with plenty of headroom: available covers any single
+// process's remaining need, so early requests are granted and later ones
+// start hitting shortages and unsafe states
+BankerState roomyState(std::mt19937& rng, int P, int R) {
+    std::vector<std::vector<int>> max(P, std::vector<int>(R));
+    std::vector<std::vector<int>> allocation(P, std::vector<int>(R));
+    std::vector<int> available(R, 0);
     for (int i = 0; i < P; i++) {
         for (int j = 0; j < R; j++) {
-            need[i][j] = max[i][j] - allocation[i][j];
+            max[i][j] = rng() % 11;
+            allocation[i][j] = static_cast<int>(rng() % (max[i][j] / 2 + 1));
+            available[j] = std::max(available[j], max[i][j] - allocation[i][j]);
         }
     }
+    for (int& a : available) a *= 3;
+    return BankerState(available, max, allocation);
+}
 
-    // 1. Check if request <= need
-    for (int i = 0; i < R; i++) {
-        if (request[i] > need[processId][i]) {
-            std::cout << "Error: Process has exceeded its maximum claim.\n";
-            return;
+int benchmarkBatch(int P, int requests) {
+    const int R = 8;
+    std::mt19937 rng(17);
+    BankerState initial = roomyState(rng, P, R);
+
+    std::vector<PendingRequest> batch(requests);
+    for (auto& pr : batch) {
+        pr.processId = rng() % P;
+        pr.request.resize(R);
+        for (int j = 0; j < R; j++) {
+            int needJ = initial.needRow(pr.processId)[j];
+            pr.request[j] = static_cast<int>(rng() % (needJ / 3 + 1));
         }
+        pr.priority = rng() % 4;
     }
 
-    // 2. Check if request <= available
-    for (int i = 0; i < R; i++) {
-        if (request[i] > available[i]) {
-            std::cout << "Process must wait, resources not available.\n";
-            return;
+    // Baseline: one request() at a time, which is what FIFO batching must match
+    BankerState oneByOne = initial;
+    std::vector<size_t> expected;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (oneByOne.request(batch[i].processId, batch[i].request) == RequestResult::Granted) expected.push_back(i);
+    }
+    std::chrono::duration<double, std::milli> baseline = std::chrono::steady_clock::now() - start;
+    std::cout << "P = " << P << ", R = " << R << ", " << requests << " pending requests\n";
+    std::cout << "  " << std::left << std::setw(28) << "one at a time" << std::right << expected.size() << " granted in " << baseline.count() << " ms\n";
+
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    const char* names[] = {"FIFO", "smallest-first", "priority"};
+    BatchOrder orders[] = {BatchOrder::FIFO, BatchOrder::SmallestFirst, BatchOrder::Priority};
+    for (int o = 0; o < 3; o++) {
+        std::vector<size_t> sequential;
+        for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            BankerState state = initial;
+            start = std::chrono::steady_clock::now();
+            BatchResult result = admitBatch(state, batch, orders[o], p);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            std::string label = std::string("batch ") + names[o] + (p ? " +pool" : "");
+            std::cout << "  " << std::left << std::setw(28) << label << std::right << result.granted.size() << " granted, " << result.deferred.size() << " deferred in "
+                      << elapsed.count() << " ms\n";
+            if (orders[o] == BatchOrder::FIFO && result.granted != expected) {
+                std::cout << "FAILED: FIFO batch differs from one-at-a-time admission\n";
+                return 1;
+            }
+            if (p && result.granted != sequential) {
+                std::cout << "FAILED: pooled screening changed the granted set\n";
+                return 1;
+            }
+            sequential = result.granted;
+            if (!state.isSafe()) {
+                std::cout << "FAILED: batch left the system unsafe\n";
+                return 1;
+            }
         }
     }
+    return 0;
+}
+
+// Many threads, one per process, cycling through random requests and
+// releases against one ResourceManager while a monitor audits the state
+int stressResourceManager(int threads, int cyclesPerThread) {
+    const int R = 4;
+    std::mt19937 setup(99);
+    std::vector<std::vector<int>> max(threads, std::vector<int>(R));
+    std::vector<std::vector<int>> allocation(threads, std::vector<int>(R, 0));
+    for (auto& row : max) {
+        for (int& m : row) m = 1 + setup() % 6;
+    }
+    // Enough for a few processes at their full claim, far from all of them
+    std::vector<int> available(R, 8);
+    BankerState initial(available, max, allocation);
+    initial.setSafetyAlgorithm(SafetyAlgorithm::Sorted);
+    ResourceManager manager(std::move(initial));
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> violated{false};
+    std::atomic<long> grants{0};
+    std::atomic<long> timeouts{0};
+    std::vector<std::vector<double>> latencies(threads);
+
+    std::thread monitor([&] {
+        while (!done) {
+            if (!manager.audit()) violated = true;
+            std::this_thread::yield();
+        }
+    });
 
-    // 3. Pretend to allocate resources
-    std::vector<int> tempAvailable = available;
-    std::vector<std::vector<int>> tempAllocation = allocation;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            std::vector<int> req(R);
+            for (int c = 0; c < cyclesPerThread; c++) {
+                std::vector<int> need = manager.needOf(t);
+                for (int j = 0; j < R; j++) req[j] = need[j] > 0 ? static_cast<int>(rng() % (need[j] + 1)) : 0;
 
-    for (int i = 0; i < R; i++) {
-        tempAvailable[i] -= request[i];
-        tempAllocation[processId][i] += request[i];
+                auto start = std::chrono::steady_clock::now();
+                RequestResult result = manager.request(t, req, std::chrono::milliseconds(20));
+                std::chrono::duration<double, std::micro> waited = std::chrono::steady_clock::now() - start;
+                if (result == RequestResult::Granted) {
+                    grants++;
+                    latencies[t].push_back(waited.count());
+                } else if (result == RequestResult::TimedOut) {
+                    timeouts++;
+                }
+
+                // Hold what we have for a moment so other threads contend
+                if (result == RequestResult::Granted) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(rng() % 50));
+                }
+
+                // Finish (release everything) half the time, or after a
+                // timeout so the process does not sit on what it holds
+                if (result == RequestResult::TimedOut || rng() % 2 == 0) {
+                    manager.release(t, manager.allocationOf(t));
+                }
+            }
+            manager.release(t, manager.allocationOf(t));
+        });
     }
-    
-    // 4. Run safety algorithm on the new state
-    if (isSafe(tempAvailable, max, tempAllocation)) {
-        std::cout << "Request granted!\n";
-        // If safe, permanently update the state
-        available = tempAvailable;
-        allocation = tempAllocation;
-    } else {
-        std::cout << "Request denied as it leads to an unsafe state.\n";
+    for (auto& w : workers) w.join();
+    done = true;
+    monitor.join();
+
+    std::vector<double> all;
+    for (const auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double q) {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(q * all.size()))];
+    };
+
+    std::cout << threads << " threads x " << cyclesPerThread << " cycles: " << grants << " grants, "
+              << timeouts << " timeouts\n";
+    std::cout << "Grant latency (us): p50 " << percentile(0.50) << ", p90 " << percentile(0.90)
+              << ", p99 " << percentile(0.99) << ", max " << (all.empty() ? 0.0 : all.back()) << "\n";
+    if (violated || !manager.audit()) {
+        std::cout << "FAILED: the manager reached an unsafe or inconsistent state\n";
+        return 1;
     }
+    std::cout << "State stayed safe and consistent throughout\n";
+    return 0;
 }
 
-int main() {
+// Random request/release stream against an incremental detector and a
+// twin that runs the full detection algorithm after every event; the two
+// deadlocked sets must agree. Deadlocks are broken by aborting the
+// suggested victim.
+int benchmarkDetection(int P, int events) {
+    // Many resource types with two units each, and requests that touch one
+    // or two of them, like processes taking locks and buffers
+    const int R = 64;
+    std::mt19937 rng(5);
+    std::vector<int> available(R, 2);
+    DeadlockDetector incremental(P, available);
+    DeadlockDetector full(P, available);
+    full.incremental = false;
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration incrementalTime{}, fullTime{};
+    long blockedRequests = 0, deadlocks = 0, victims = 0;
+    std::vector<int> vec(R);
+    for (int e = 0; e < events; e++) {
+        int p = rng() % P;
+        if (incremental.isBlocked(p)) continue;
+        bool isRequest = rng() % 2 == 0;
+        if (isRequest) {
+            std::fill(vec.begin(), vec.end(), 0);
+            vec[rng() % R] += 1 + rng() % 2;
+            vec[rng() % R] += static_cast<int>(rng() % 2);
+        } else {
+            const int* held = incremental.allocationRow(p);
+            for (int j = 0; j < R; j++) vec[j] = static_cast<int>(rng() % (held[j] + 1));
+        }
+
+        auto start = Clock::now();
+        bool granted = isRequest ? incremental.request(p, vec) : incremental.release(p, vec);
+        incrementalTime += Clock::now() - start;
+        start = Clock::now();
+        if (isRequest) {
+            full.request(p, vec);
+        } else {
+            full.release(p, vec);
+        }
+        const std::vector<int>& expected = full.detect();
+        fullTime += Clock::now() - start;
+        if (isRequest && !granted) blockedRequests++;
+
+        if (incremental.deadlockedProcesses() != expected) {
+            std::cout << "FAILED: incremental detection disagrees with a full rescan after event " << e << "\n";
+            return 1;
+        }
+        if (expected.empty()) continue;
+
+        // Abort victims until the deadlock is gone
+        deadlocks++;
+        while (!incremental.deadlockedProcesses().empty()) {
+            int victim = incremental.suggestVictim();
+            start = Clock::now();
+            incremental.abort(victim);
+            incrementalTime += Clock::now() - start;
+            start = Clock::now();
+            full.abort(victim);
+            const std::vector<int>& after = full.detect();
+            fullTime += Clock::now() - start;
+            victims++;
+            if (incremental.deadlockedProcesses() != after) {
+                std::cout << "FAILED: incremental detection disagrees with a full rescan after aborting P" << victim << "\n";
+                return 1;
+            }
+        }
+    }
+
+    auto perEvent = [&](Clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count() / events;
+    };
+    std::cout << "P = " << P << ", R = " << R << ", " << events << " events: " << blockedRequests
+              << " blocked requests, " << deadlocks << " deadlocks, " << victims << " victims aborted\n";
+    std::cout << "Per event (us): incremental " << perEvent(incrementalTime) << ", full rescan "
+              << perEvent(fullTime) << "\n";
+    std::cout << "Incremental detection matched the full rescan after every event\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "verify") {
+        return verifySafetyAlgorithms(argc > 2 ? std::stoi(argv[2]) : 20000);
+    }
+    if (mode == "bench") {
+        benchmarkSafetyAlgorithms();
+        return 0;
+    }
+    if (mode == "bench-kernel") {
+        benchmarkKernel();
+        return 0;
+    }
+    if (mode == "stress") {
+        int threads = argc > 2 ? std::stoi(argv[2]) : 32;
+        int cycles = argc > 3 ? std::stoi(argv[3]) : 2000;
+        return stressResourceManager(threads, cycles);
+    }
+    if (mode == "batch") {
+        int P = argc > 2 ? std::stoi(argv[2]) : 2000;
+        int requests = argc > 3 ? std::stoi(argv[3]) : 500;
+        return benchmarkBatch(P, requests);
+    }
+    if (mode == "detect") {
+        int P = argc > 2 ? std::stoi(argv[2]) : 2000;
+        int events = argc > 3 ? std::stoi(argv[3]) : 20000;
+        return benchmarkDetection(P, events);
+    }
+    if (!mode.empty()) {
+        std::cerr << "Usage: banker [verify [rounds] | bench | bench-kernel | stress [threads] [cycles]"
+                  << " | batch [processes] [requests] | detect [processes] [events]]\n";
+        return 1;
+    }
+
     std::vector<std::vector<int>> allocation = {
         {0, 1, 0},
         {2, 0, 0},
@@ -121,21 +1568,23 @@ int main() {
 
     std::vector<int> available = {3, 3, 2};
 
+    BankerState state(available, max, allocation);
+
     // Check initial state
     std::cout << "--- Initial System State Check ---\n";
-    isSafe(available, max, allocation);
+    printSafety(state, state.isSafe());
 
     // Simulate a resource request
     // Request from P1 for (1, 0, 2)
-    resourceRequest(1, {1, 0, 2}, available, max, allocation);
-    
+    resourceRequest(state, 1, {1, 0, 2});
+
     // Simulate another resource request that might fail
     // Request from P4 for (3, 3, 0)
-    resourceRequest(4, {3, 3, 0}, available, max, allocation);
-    
+    resourceRequest(state, 4, {3, 3, 0});
+
     // Simulate another request from P0
     // Request from P0 for (0, 2, 0)
-    resourceRequest(0, {0, 2, 0}, available, max, allocation);
+    resourceRequest(state, 0, {0, 2, 0});
 
     return 0;
-}
\ No newline at end of file
+}
@@ -2,52 +2,217 @@
 #include <list>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <functional>
+#include <tuple>
 #include <sstream>
 #include <vector>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <iomanip>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+// How the index refers to a key that lives in the item list, so keys are
+// stored once. String keys are indexed by string_view when the hash is
+// transparent (accepts string_view), which lets get() and friends take any
+// string-like argument without building a std::string; otherwise they are
+// indexed by reference like any other key.
+template <typename K, bool ByStringView = false>
+struct KeyView {
+    using type = std::reference_wrapper<const K>;
+    using arg_type = const K&;
+
+    static type of(const K& key) {
+        return std::cref(key);
+    }
+
+    static const K& unwrap(type view) {
+        return view.get();
+    }
+};
+
+template <>
+struct KeyView<std::string, true> {
+    using type = std::string_view;
+    using arg_type = std::string_view;
+
+    static type of(std::string_view key) {
+        return key;
+    }
+
+    static std::string_view unwrap(type view) {
+        return view;
+    }
+};
+
+template <typename K>
+struct DefaultKeyHash : std::hash<K> {};
+
+template <>
+struct DefaultKeyHash<std::string> : std::hash<std::string_view> {
+    using is_transparent = void;
+};
+
+template <typename Hash, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename Hash>
+struct IsTransparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type {};
+
+// Key/value LRU cache. Values are constructed in place, never copied on
+// insert, hit or eviction, and may be move-only. The eviction callback
+// receives the value by reference so it can move it elsewhere.
+// refer()/access() keep the page-simulation surface (the page is its own
+// value) for caches whose V is constructible from K.
+template <typename K = int, typename V = int, typename Hash = DefaultKeyHash<K>>
 class LRUCache {
 private:
+    using Keys = KeyView<K, std::is_same_v<K, std::string> && IsTransparent<Hash>::value>;
+    using View = typename Keys::type;
+    using Arg = typename Keys::arg_type;
+    using Item = std::pair<const K, V>;
+
+    struct ViewHash {
+        Hash hash;
+        size_t operator()(const View& view) const {
+            return hash(Keys::unwrap(view));
+        }
+    };
+
+    struct ViewEqual {
+        bool operator()(const View& a, const View& b) const {
+            return Keys::unwrap(a) == Keys::unwrap(b);
+        }
+    };
+
     int capacity;
     // list of {key, value} pairs. The front is most recent.
-    std::list<std::pair<int, int>> items; 
-    // map from key to an iterator pointing to its position in the list
-    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> cacheMap; 
+    std::list<Item> items;
+    // map from a view of the key to an iterator pointing to its position in the list
+    std::unordered_map<View, typename std::list<Item>::iterator, ViewHash, ViewEqual> cacheMap;
+    std::function<void(const K&, V&)> onEvict;
     int pageFaults = 0;
 
+    void evictLRU() {
+        Item& lru = items.back();
+        if (onEvict) onEvict(lru.first, lru.second);
+        cacheMap.erase(Keys::of(lru.first));
+        items.pop_back();
+    }
+
 public:
-    LRUCache(int cap) : capacity(cap) {}
+    LRUCache(int cap, std::function<void(const K&, V&)> evictionCallback = nullptr)
+        : capacity(cap), onEvict(std::move(evictionCallback)) {
+        cacheMap.reserve(cap);
+    }
 
-    void refer(int key) {
+    // The index points into items, so copies would alias the original
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+    LRUCache(LRUCache&&) = default;
+    LRUCache& operator=(LRUCache&&) = default;
+
+    // Returns the cached value and marks it most recent, or nullptr
+    V* get(Arg key) {
+        auto it = cacheMap.find(Keys::of(key));
+        if (it == cacheMap.end()) return nullptr;
+        items.splice(items.begin(), items, it->second);
+        return &it->second->second;
+    }
+
+    // Like get() but leaves the recency order alone
+    const V* peek(Arg key) const {
+        auto it = cacheMap.find(Keys::of(key));
+        return it == cacheMap.end() ? nullptr : &it->second->second;
+    }
+
+    bool contains(Arg key) const {
+        return cacheMap.count(Keys::of(key)) > 0;
+    }
+
+    // Constructs V(args...) in place unless key is already cached; either
+    // way the entry becomes most recent. Returns the value and whether it
+    // was inserted.
+    template <typename... Args>
+    std::pair<V*, bool> emplace(K key, Args&&... args) {
+        auto it = cacheMap.find(Keys::of(key));
+        if (it != cacheMap.end()) {
+            items.splice(items.begin(), items, it->second);
+            return {&it->second->second, false};
+        }
+        if (items.size() == static_cast<size_t>(capacity)) {
+            evictLRU();
+        }
+        items.emplace_front(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+        cacheMap.emplace(Keys::of(items.front().first), items.begin());
+        return {&items.front().second, true};
+    }
+
+    // Inserts or overwrites; value is moved in
+    V& put(K key, V value) {
+        auto result = emplace(std::move(key), std::move(value));
+        if (!result.second) *result.first = std::move(value);
+        return *result.first;
+    }
+
+    bool erase(Arg key) {
+        auto it = cacheMap.find(Keys::of(key));
+        if (it == cacheMap.end()) return false;
+        auto item = it->second;
+        cacheMap.erase(it);
+        items.erase(item);
+        return true;
+    }
+
+    size_t size() const {
+        return items.size();
+    }
+
+    // Same bookkeeping as refer() but without any output. Returns true on a hit.
+    bool access(const K& key) {
+        if (get(key)) return true;
+        pageFaults++;
+        emplace(key, key); // Using key as value for simplicity
+        return false;
+    }
+
+    void refer(const K& key) {
         std::cout << "Referring to page " << key << ": ";
-        
-        // Case 1: Page is NOT in cache (Page Fault)
-        if (cacheMap.find(key) == cacheMap.end()) {
-            pageFaults++;
-            std::cout << "Page Fault! -> ";
 
-            // Case 1a: Cache is full, need to evict LRU page
-            if (items.size() == capacity) {
-                // Get the least recently used item (at the back of the list)
-                std::pair<int, int> lru = items.back();
-                items.pop_back();
-                cacheMap.erase(lru.first);
-                 std::cout << "Cache full, evicting page " << lru.first << ". ";
-            }
-             // Add the new page to the front (most recent)
-            items.push_front({key, key}); // Using key as value for simplicity
-            cacheMap[key] = items.begin();
-            std::cout << "Loaded page " << key << ".\n";
-        } 
-        // Case 2: Page IS in cache (Cache Hit)
-        else {
+        // Remember the LRU page before access() possibly evicts it
+        bool full = items.size() == static_cast<size_t>(capacity);
+        K lru = full ? items.back().first : K();
+
+        // Case 1: Page IS in cache (Cache Hit)
+        if (access(key)) {
             std::cout << "Cache Hit!\n";
-            // Move the accessed item to the front to mark it as most recently used
-            items.splice(items.begin(), items, cacheMap[key]);
+        }
+        // Case 2: Page is NOT in cache (Page Fault)
+        else {
+            std::cout << "Page Fault! -> ";
+            if (full) {
+                std::cout << "Cache full, evicting page " << lru << ". ";
+            }
+            std::cout << "Loaded page " << key << ".\n";
         }
         printCacheState();
     }
-    
-    void printCacheState() {
+
+    void printCacheState() const {
         std::cout << "Cache State: [ ";
         for(const auto& item : items) {
             std::cout << item.first << " ";
@@ -60,25 +225,1925 @@ public:
     }
 };
 
-int main() {
-    int cacheCapacity = 4;
-    LRUCache lru(cacheCapacity);
+// Fixed-capacity LRU cache that never allocates after construction.
+// Slots live in one array and are chained by 32-bit prev/next indices
+// (head is most recent). Keys are found through an open-addressing index
+// with linear probing and backward-shift deletion, so a hit is a single
+// probe sequence plus a few index writes.
+class FlatLRUCache {
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
 
-    // A sample reference string of page numbers
-    std::vector<int> referenceString = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+    struct Slot {
+        int key;
+        uint32_t prev;
+        uint32_t next;
+    };
 
-    std::cout << "Simulating LRU Cache with capacity " << cacheCapacity << "\n";
-    std::cout << "Reference String: ";
-    for(int page : referenceString) std::cout << page << " ";
-    std::cout << "\n---------------------------------------\n\n";
+    uint32_t capacity;
+    uint32_t used = 0;
+    uint32_t head = NIL;
+    uint32_t tail = NIL;
+    std::vector<Slot> slots;
 
-    for (int page : referenceString) {
-        lru.refer(page);
+    // index[b] is the slot holding the key stored in bucket b, or NIL
+    std::vector<uint32_t> index;
+    uint32_t mask;
+    int shift;
+    int pageFaults = 0;
+
+    uint32_t home(int key) const {
+        return (static_cast<uint32_t>(key) * 0x9E3779B9u) >> shift;
+    }
+
+    // Bucket holding key, or the empty bucket where it would go
+    uint32_t probe(int key) const {
+        uint32_t b = home(key);
+        while (index[b] != NIL && slots[index[b]].key != key) {
+            b = (b + 1) & mask;
+        }
+        return b;
+    }
+
+    // Backward-shift deletion keeps probe chains tombstone-free
+    void eraseBucket(uint32_t hole) {
+        uint32_t b = (hole + 1) & mask;
+        while (index[b] != NIL) {
+            uint32_t h = home(slots[index[b]].key);
+            // Move b into the hole unless its home lies cyclically in (hole, b]
+            if (((b - h) & mask) >= ((b - hole) & mask)) {
+                index[hole] = index[b];
+                hole = b;
+            }
+            b = (b + 1) & mask;
+        }
+        index[hole] = NIL;
+    }
+
+    void unlink(uint32_t s) {
+        if (slots[s].prev != NIL) slots[slots[s].prev].next = slots[s].next; else head = slots[s].next;
+        if (slots[s].next != NIL) slots[slots[s].next].prev = slots[s].prev; else tail = slots[s].prev;
+    }
+
+    void pushFront(uint32_t s) {
+        slots[s].prev = NIL;
+        slots[s].next = head;
+        if (head != NIL) slots[head].prev = s; else tail = s;
+        head = s;
+    }
+
+public:
+    FlatLRUCache(int cap) : capacity(static_cast<uint32_t>(cap)) {
+        // An empty cache would have no slot to evict into
+        if (cap < 1) throw std::invalid_argument("FlatLRUCache capacity must be at least 1");
+        slots.resize(cap);
+        // Keep the load factor at or below 1/2
+        uint32_t buckets = 2;
+        shift = 31;
+        while (buckets < 2 * capacity) {
+            buckets <<= 1;
+            shift--;
+        }
+        index.assign(buckets, NIL);
+        mask = buckets - 1;
+    }
+
+    // Returns true on a hit. No heap allocation on either path.
+    bool access(int key) {
+        uint32_t b = probe(key);
+        if (index[b] != NIL) {
+            uint32_t s = index[b];
+            if (s != head) {
+                unlink(s);
+                pushFront(s);
+            }
+            return true;
+        }
+
+        pageFaults++;
+        uint32_t s;
+        if (used < capacity) {
+            s = used++;
+        } else {
+            // Reuse the LRU slot; its deletion may shift the probe chain for key
+            s = tail;
+            unlink(s);
+            eraseBucket(probe(slots[s].key));
+            b = probe(key);
+        }
+        slots[s].key = key;
+        index[b] = s;
+        pushFront(s);
+        return false;
+    }
+
+    bool contains(int key) const {
+        return index[probe(key)] != NIL;
+    }
+
+    // Marks key most recently used if it is still cached; never faults
+    void touch(int key) {
+        uint32_t b = probe(key);
+        if (index[b] != NIL && index[b] != head) {
+            unlink(index[b]);
+            pushFront(index[b]);
+        }
+    }
+
+    void printCacheState() const {
+        std::cout << "Cache State: [ ";
+        for (uint32_t s = head; s != NIL; s = slots[s].next) {
+            std::cout << slots[s].key << " ";
+        }
+        std::cout << "]\n\n";
+    }
+
+    int getPageFaults() const {
+        return pageFaults;
+    }
+};
+
+// Thread-safe LRU that partitions keys across independently locked shards,
+// each an LRU of about capacity/N pages. Eviction is LRU within a shard.
+class ShardedLRUCache {
+private:
+    struct alignas(64) Shard {
+        std::shared_mutex lock;
+        FlatLRUCache cache;
+        Shard(int cap) : cache(cap) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    size_t shardOf(int key) const {
+        uint32_t h = static_cast<uint32_t>(key);
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        return h % shards.size();
+    }
+
+public:
+    ShardedLRUCache(int cap, int shardCount) {
+        // Every shard holds at least one page, so never more shards than pages
+        shardCount = std::max(1, std::min(shardCount, cap));
+        for (int i = 0; i < shardCount; i++) {
+            // Spread the remainder so total capacity is exactly cap
+            int shardCap = cap / shardCount + (i < cap % shardCount ? 1 : 0);
+            shards.push_back(std::make_unique<Shard>(shardCap));
+        }
+    }
+
+    // Returns true on a hit; locks only the key's shard
+    bool access(int key) {
+        Shard& shard = *shards[shardOf(key)];
+        std::unique_lock<std::shared_mutex> guard(shard.lock);
+        return shard.cache.access(key);
+    }
+
+    int getPageFaults() const {
+        int faults = 0;
+        for (const auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> guard(shard->lock);
+            faults += shard->cache.getPageFaults();
+        }
+        return faults;
+    }
+
+    // Per-thread handle for read-mostly workloads. Hits are detected under a
+    // shared lock and their promotions are queued locally, then applied to
+    // the shard in one exclusive section once batchSize of them pile up.
+    // Recency is therefore slightly stale until the next flush.
+    class Referrer {
+    private:
+        ShardedLRUCache& owner;
+        size_t batchSize;
+        std::vector<std::vector<int>> pending;
+
+        void flushShard(size_t i) {
+            if (pending[i].empty()) return;
+            Shard& shard = *owner.shards[i];
+            std::unique_lock<std::shared_mutex> guard(shard.lock);
+            for (int key : pending[i]) {
+                shard.cache.touch(key);
+            }
+            pending[i].clear();
+        }
+
+    public:
+        Referrer(ShardedLRUCache& cache, size_t batch = 64)
+            : owner(cache), batchSize(batch), pending(cache.shards.size()) {
+            for (auto& buffer : pending) buffer.reserve(batchSize);
+        }
+
+        ~Referrer() {
+            flush();
+        }
+
+        bool access(int key) {
+            size_t i = owner.shardOf(key);
+            Shard& shard = *owner.shards[i];
+            {
+                std::shared_lock<std::shared_mutex> guard(shard.lock);
+                if (shard.cache.contains(key)) {
+                    pending[i].push_back(key);
+                    if (pending[i].size() < batchSize) return true;
+                } else {
+                    guard.unlock();
+                    // Apply our queued promotions first so they are not lost
+                    // to an eviction this fault would cause
+                    flushShard(i);
+                    std::unique_lock<std::shared_mutex> writer(shard.lock);
+                    return shard.cache.access(key);
+                }
+            }
+            flushShard(i);
+            return true;
+        }
+
+        void flush() {
+            for (size_t i = 0; i < pending.size(); i++) {
+                flushShard(i);
+            }
+        }
+    };
+};
+
+// What sharing LRUCache looks like without sharding: one lock around it all
+class GlobalLockLRUCache {
+private:
+    std::mutex lock;
+    LRUCache<> cache;
+
+public:
+    GlobalLockLRUCache(int cap) : cache(cap) {}
+
+    bool access(int key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return cache.access(key);
+    }
+
+    int getPageFaults() const {
+        return cache.getPageFaults();
+    }
+};
+
+// Pool of keys threaded onto a few index-linked recency lists (front is
+// most recent). Eviction policies below keep resident and ghost entries
+// in one pool and move keys between lists in O(1).
+class SlotLists {
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        int key;
+        uint32_t prev;
+        uint32_t next;
+        int list;
+    };
+
+    struct Ends {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+        size_t size = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::vector<Ends> lists;
+    std::unordered_map<int, uint32_t> where;
+
+    void unlink(uint32_t n) {
+        Ends& l = lists[nodes[n].list];
+        if (nodes[n].prev != NIL) nodes[nodes[n].prev].next = nodes[n].next; else l.head = nodes[n].next;
+        if (nodes[n].next != NIL) nodes[nodes[n].next].prev = nodes[n].prev; else l.tail = nodes[n].prev;
+        l.size--;
+    }
+
+    void linkFront(int list, uint32_t n) {
+        Ends& l = lists[list];
+        nodes[n].list = list;
+        nodes[n].prev = NIL;
+        nodes[n].next = l.head;
+        if (l.head != NIL) nodes[l.head].prev = n; else l.tail = n;
+        l.head = n;
+        l.size++;
+    }
+
+public:
+    SlotLists(int listCount, size_t maxKeys) : lists(listCount) {
+        nodes.reserve(maxKeys);
+        where.reserve(maxKeys);
+    }
+
+    // List holding key, or -1
+    int find(int key) const {
+        auto it = where.find(key);
+        return it == where.end() ? -1 : nodes[it->second].list;
+    }
+
+    size_t size(int list) const {
+        return lists[list].size;
+    }
+
+    int back(int list) const {
+        return nodes[lists[list].tail].key;
+    }
+
+    // key must not be present in any list
+    void pushFront(int list, int key) {
+        uint32_t n;
+        if (!freeNodes.empty()) {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            n = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({});
+        }
+        nodes[n].key = key;
+        linkFront(list, n);
+        where[key] = n;
+    }
+
+    // Moves key (present in any list) to the front of list
+    void moveToFront(int list, int key) {
+        uint32_t n = where.find(key)->second;
+        unlink(n);
+        linkFront(list, n);
+    }
+
+    // Removes and returns the least recent key of a non-empty list
+    int popBack(int list) {
+        int key = back(list);
+        erase(key);
+        return key;
+    }
+
+    void erase(int key) {
+        auto it = where.find(key);
+        unlink(it->second);
+        freeNodes.push_back(it->second);
+        where.erase(it);
+    }
+
+    template <typename Fn>
+    void forEach(int list, Fn fn) const {
+        for (uint32_t n = lists[list].head; n != NIL; n = nodes[n].next) fn(nodes[n].key);
+    }
+};
+
+// Eviction policies for PolicyCache. Each provides:
+//   bool lookup(int key)               hit check; updates recency/frequency
+//   bool insert(int key, int& evicted) load key after a miss; true if it
+//                                      evicted a resident page
+//   forEachResident(fn)                resident pages, roughly hottest first
+//   static const char* name()
+
+// Plain LRU, the behaviour of LRUCache
+class LRUPolicy {
+private:
+    size_t capacity;
+    SlotLists lists;
+
+public:
+    LRUPolicy(int cap) : capacity(cap), lists(1, cap) {}
+
+    static const char* name() {
+        return "LRU";
+    }
+
+    bool lookup(int key) {
+        if (lists.find(key) < 0) return false;
+        lists.moveToFront(0, key);
+        return true;
+    }
+
+    bool insert(int key, int& evicted) {
+        bool full = lists.size(0) == capacity;
+        if (full) evicted = lists.popBack(0);
+        lists.pushFront(0, key);
+        return full;
+    }
+
+    template <typename Fn>
+    void forEachResident(Fn fn) const {
+        lists.forEach(0, fn);
+    }
+};
+
+// Second-chance CLOCK: hits only set a reference bit, and the hand clears
+// bits until it finds an unreferenced frame to replace
+class ClockPolicy {
+private:
+    struct Frame {
+        int key;
+        bool referenced;
+    };
+
+    size_t capacity;
+    size_t hand = 0;
+    std::vector<Frame> frames;
+    std::unordered_map<int, uint32_t> where;
+
+public:
+    ClockPolicy(int cap) : capacity(cap) {
+        frames.reserve(cap);
+        where.reserve(cap);
+    }
+
+    static const char* name() {
+        return "CLOCK";
+    }
+
+    bool lookup(int key) {
+        auto it = where.find(key);
+        if (it == where.end()) return false;
+        frames[it->second].referenced = true;
+        return true;
+    }
+
+    bool insert(int key, int& evicted) {
+        if (frames.size() < capacity) {
+            where[key] = static_cast<uint32_t>(frames.size());
+            frames.push_back({key, false});
+            return false;
+        }
+        while (frames[hand].referenced) {
+            frames[hand].referenced = false;
+            hand = (hand + 1) % capacity;
+        }
+        evicted = frames[hand].key;
+        where.erase(evicted);
+        frames[hand] = {key, false};
+        where[key] = static_cast<uint32_t>(hand);
+        hand = (hand + 1) % capacity;
+        return true;
+    }
+
+    template <typename Fn>
+    void forEachResident(Fn fn) const {
+        for (size_t i = 0; i < frames.size(); i++) fn(frames[(hand + i) % frames.size()].key);
+    }
+};
+
+// Full 2Q (Johnson & Shasha): first-time pages enter the A1in FIFO, pages
+// evicted from it are remembered in the A1out ghost queue, and only pages
+// re-referenced while in A1out are promoted to the main LRU queue Am.
+// A one-pass scan therefore never displaces Am.
+class TwoQPolicy {
+private:
+    enum { A1IN, AM, A1OUT };
+
+    size_t capacity;
+    size_t kin;
+    size_t kout;
+    SlotLists lists;
+
+    bool reclaim(int& evicted) {
+        if (lists.size(A1IN) + lists.size(AM) < capacity) return false;
+        if (lists.size(A1IN) > kin || lists.size(AM) == 0) {
+            evicted = lists.back(A1IN);
+            lists.moveToFront(A1OUT, evicted);
+            if (lists.size(A1OUT) > kout) lists.popBack(A1OUT);
+        } else {
+            evicted = lists.popBack(AM);
+        }
+        return true;
+    }
+
+public:
+    TwoQPolicy(int cap)
+        : capacity(cap), kin(std::max(1, cap / 4)), kout(std::max(1, cap / 2)), lists(3, cap + cap / 2 + 1) {}
+
+    static const char* name() {
+        return "2Q";
+    }
+
+    bool lookup(int key) {
+        int list = lists.find(key);
+        if (list == AM) lists.moveToFront(AM, key);
+        return list == AM || list == A1IN;
+    }
+
+    bool insert(int key, int& evicted) {
+        bool remembered = lists.find(key) == A1OUT;
+        if (remembered) lists.erase(key);
+        bool full = reclaim(evicted);
+        lists.pushFront(remembered ? AM : A1IN, key);
+        return full;
+    }
+
+    template <typename Fn>
+    void forEachResident(Fn fn) const {
+        lists.forEach(AM, fn);
+        lists.forEach(A1IN, fn);
+    }
+};
+
+// ARC (Megiddo & Modha): T1 holds pages seen once, T2 pages seen at least
+// twice, and the ghost lists B1/B2 remember recent evictions from each.
+// Ghost hits move the target size p of T1, adapting between recency and
+// frequency without tuning.
+class ARCPolicy {
+private:
+    enum { T1, T2, B1, B2 };
+
+    size_t capacity;
+    size_t p = 0;
+    SlotLists lists;
+
+    void replace(bool inB2, int& evicted) {
+        size_t t1 = lists.size(T1);
+        if (t1 > 0 && (t1 > p || (inB2 && t1 == p))) {
+            evicted = lists.back(T1);
+            lists.moveToFront(B1, evicted);
+        } else {
+            evicted = lists.back(T2);
+            lists.moveToFront(B2, evicted);
+        }
+    }
+
+public:
+    ARCPolicy(int cap) : capacity(cap), lists(4, 2 * static_cast<size_t>(cap)) {}
+
+    static const char* name() {
+        return "ARC";
+    }
+
+    bool lookup(int key) {
+        int list = lists.find(key);
+        if (list != T1 && list != T2) return false;
+        lists.moveToFront(T2, key);
+        return true;
+    }
+
+    bool insert(int key, int& evicted) {
+        size_t b1 = lists.size(B1);
+        size_t b2 = lists.size(B2);
+        bool full = lists.size(T1) + lists.size(T2) >= capacity;
+        int list = lists.find(key);
+
+        if (list == B1) {
+            p = std::min(capacity, p + std::max<size_t>(b2 / b1, 1));
+            if (full) replace(false, evicted);
+            lists.moveToFront(T2, key);
+            return full;
+        }
+        if (list == B2) {
+            size_t delta = std::max<size_t>(b1 / b2, 1);
+            p = p > delta ? p - delta : 0;
+            if (full) replace(true, evicted);
+            lists.moveToFront(T2, key);
+            return full;
+        }
+
+        size_t l1 = lists.size(T1) + b1;
+        if (l1 == capacity) {
+            if (lists.size(T1) < capacity) {
+                lists.popBack(B1);
+                if (full) replace(false, evicted);
+            } else {
+                evicted = lists.popBack(T1);
+            }
+        } else if (l1 < capacity && l1 + lists.size(T2) + b2 >= capacity) {
+            if (l1 + lists.size(T2) + b2 == 2 * capacity) lists.popBack(B2);
+            if (full) replace(false, evicted);
+        }
+        lists.pushFront(T1, key);
+        return full;
+    }
+
+    template <typename Fn>
+    void forEachResident(Fn fn) const {
+        lists.forEach(T2, fn);
+        lists.forEach(T1, fn);
+    }
+};
+
+// Count-min sketch of access frequency with 4-bit-range counters that are
+// halved every sampleSize increments, so old popularity fades
+class FrequencySketch {
+private:
+    std::vector<uint8_t> table;
+    size_t mask;
+    size_t additions = 0;
+    size_t sampleSize;
+
+    size_t slot(int key, int row) const {
+        uint64_t x = static_cast<uint32_t>(key) * 0x9E3779B97F4A7C15ull + row * 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 31;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 29;
+        return (row * (mask + 1)) + (x & mask);
+    }
+
+public:
+    FrequencySketch(size_t capacity) {
+        size_t width = 16;
+        while (width < capacity) width <<= 1;
+        mask = width - 1;
+        table.assign(4 * width, 0);
+        sampleSize = 10 * std::max<size_t>(capacity, 1);
     }
-    
+
+    // Conservative update: only the smallest counters grow
+    void increment(int key) {
+        int f = frequency(key);
+        if (f < 15) {
+            for (int row = 0; row < 4; row++) {
+                uint8_t& c = table[slot(key, row)];
+                if (c == f) c++;
+            }
+        }
+        if (++additions == sampleSize) {
+            for (uint8_t& c : table) c >>= 1;
+            additions /= 2;
+        }
+    }
+
+    int frequency(int key) const {
+        int f = 15;
+        for (int row = 0; row < 4; row++) f = std::min<int>(f, table[slot(key, row)]);
+        return f;
+    }
+};
+
+// W-TinyLFU (Einziger et al.): new pages enter a small LRU window; pages
+// leaving it compete with the main SLRU's victim and are only admitted if
+// the frequency sketch says they are more popular
+class WTinyLFUPolicy {
+private:
+    enum { WINDOW, PROBATION, PROTECTED };
+
+    size_t windowCap;
+    size_t mainCap;
+    size_t protectedCap;
+    SlotLists lists;
+    FrequencySketch sketch;
+
+public:
+    WTinyLFUPolicy(int cap)
+        : windowCap(std::max(1, cap / 100)),
+          mainCap(cap > 1 ? cap - windowCap : 0),
+          protectedCap(mainCap * 4 / 5),
+          lists(3, cap + 1),
+          sketch(cap) {}
+
+    static const char* name() {
+        return "W-TinyLFU";
+    }
+
+    bool lookup(int key) {
+        sketch.increment(key);
+        int list = lists.find(key);
+        if (list < 0) return false;
+        if (list == PROBATION) {
+            lists.moveToFront(PROTECTED, key);
+            if (lists.size(PROTECTED) > protectedCap) {
+                lists.moveToFront(PROBATION, lists.back(PROTECTED));
+            }
+        } else {
+            lists.moveToFront(list, key);
+        }
+        return true;
+    }
+
+    bool insert(int key, int& evicted) {
+        lists.pushFront(WINDOW, key);
+        if (lists.size(WINDOW) <= windowCap) return false;
+
+        int candidate = lists.back(WINDOW);
+        if (lists.size(PROBATION) + lists.size(PROTECTED) < mainCap) {
+            lists.moveToFront(PROBATION, candidate);
+            return false;
+        }
+        int victimList = lists.size(PROBATION) > 0 ? PROBATION : PROTECTED;
+        int victim = mainCap > 0 ? lists.back(victimList) : candidate;
+        if (victim != candidate && sketch.frequency(candidate) > sketch.frequency(victim)) {
+            lists.erase(victim);
+            lists.moveToFront(PROBATION, candidate);
+            evicted = victim;
+        } else {
+            lists.erase(candidate);
+            evicted = candidate;
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    void forEachResident(Fn fn) const {
+        lists.forEach(PROTECTED, fn);
+        lists.forEach(PROBATION, fn);
+        lists.forEach(WINDOW, fn);
+    }
+};
+
+// The refer()/access()/getPageFaults() surface of LRUCache over any of the
+// eviction policies above
+template <typename EvictionPolicy>
+class PolicyCache {
+private:
+    EvictionPolicy policy;
+    int pageFaults = 0;
+
+public:
+    PolicyCache(int cap) : policy(cap) {}
+
+    // Returns true on a hit. No output.
+    bool access(int key) {
+        if (policy.lookup(key)) return true;
+        pageFaults++;
+        int evicted;
+        policy.insert(key, evicted);
+        return false;
+    }
+
+    void refer(int key) {
+        std::cout << "Referring to page " << key << ": ";
+        if (policy.lookup(key)) {
+            std::cout << "Cache Hit!\n";
+        } else {
+            pageFaults++;
+            std::cout << "Page Fault! -> ";
+            int evicted;
+            if (policy.insert(key, evicted)) {
+                std::cout << "Cache full, evicting page " << evicted << ". ";
+            }
+            std::cout << "Loaded page " << key << ".\n";
+        }
+        printCacheState();
+    }
+
+    void printCacheState() const {
+        std::cout << "Cache State: [ ";
+        policy.forEachResident([](int key) { std::cout << key << " "; });
+        std::cout << "]\n\n";
+    }
+
+    int getPageFaults() const {
+        return pageFaults;
+    }
+
+    static const char* name() {
+        return EvictionPolicy::name();
+    }
+};
+
+// Reference string with locality: most references go to a small hot set
+std::vector<int> makeReferenceString(size_t length, int hotPages, int totalPages, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> hot(0, hotPages - 1);
+    std::uniform_int_distribution<int> cold(0, totalPages - 1);
+    std::bernoulli_distribution pickHot(0.9);
+
+    std::vector<int> refs(length);
+    for (auto& r : refs) {
+        r = pickHot(rng) ? hot(rng) : cold(rng);
+    }
+    return refs;
+}
+
+template <typename Cache>
+void runBenchmark(const char* name, int capacity, const std::vector<int>& refs) {
+    Cache cache(capacity);
+    auto start = std::chrono::steady_clock::now();
+    for (int page : refs) {
+        cache.access(page);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << name << ": " << refs.size() / elapsed.count() / 1e6 << " M refs/sec, "
+              << cache.getPageFaults() << " page faults\n";
+}
+
+void benchmarkLRU() {
+    const size_t length = 20000000;
+    const int capacities[] = {64, 4096, 262144};
+
+    for (int capacity : capacities) {
+        std::vector<int> refs = makeReferenceString(length, capacity, capacity * 8, 42);
+        std::cout << "Capacity " << capacity << ", " << length << " references\n";
+        runBenchmark<LRUCache<>>("LRUCache    ", capacity, refs);
+        runBenchmark<FlatLRUCache>("FlatLRUCache", capacity, refs);
+    }
+}
+
+// Runs threadCount workers, each replaying its own reference string, and
+// returns aggregate references per second
+template <typename Worker>
+double timeThreads(int threadCount, const std::vector<std::vector<int>>& refs, Worker worker) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (int t = 0; t < threadCount; t++) {
+        total += refs[t].size();
+        threads.emplace_back(worker, std::cref(refs[t]));
+    }
+    for (auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return total / elapsed.count();
+}
+
+void benchmarkConcurrentLRU() {
+    const int capacity = 65536;
+    const int shardCount = 64;
+    const size_t refsPerThread = 2000000;
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+
+    std::vector<std::vector<int>> refs;
+    for (int t = 0; t < 16; t++) {
+        refs.push_back(makeReferenceString(refsPerThread, capacity / 2, capacity * 8, 100 + t));
+    }
+
+    std::cout << "Capacity " << capacity << ", " << shardCount << " shards, "
+              << refsPerThread << " references per thread (M refs/sec)\n";
+    std::cout << std::string(8, ' ') << "Global lock   Sharded   Sharded+batched\n";
+    for (int threads : threadCounts) {
+        GlobalLockLRUCache global(capacity);
+        double g = timeThreads(threads, refs, [&](const std::vector<int>& r) {
+            for (int page : r) global.access(page);
+        });
+
+        ShardedLRUCache sharded(capacity, shardCount);
+        double s = timeThreads(threads, refs, [&](const std::vector<int>& r) {
+            for (int page : r) sharded.access(page);
+        });
+
+        ShardedLRUCache batched(capacity, shardCount);
+        double b = timeThreads(threads, refs, [&](const std::vector<int>& r) {
+            ShardedLRUCache::Referrer referrer(batched);
+            for (int page : r) referrer.access(page);
+        });
+
+        std::cout << "  " << threads << (threads < 10 ? "  " : " ") << "thr"
+                  << "  " << g / 1e6 << "     " << s / 1e6 << "     " << b / 1e6 << "\n";
+    }
+}
+
+// Read-only view of a binary trace file: raw native-endian int32 page numbers
+class MappedTrace {
+private:
+    void* base = MAP_FAILED;
+    size_t length = 0;
+
+public:
+    MappedTrace() = default;
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    ~MappedTrace() {
+        if (base != MAP_FAILED) munmap(base, length);
+    }
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: cannot open trace " << path << "\n";
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            std::cerr << "Error: cannot stat trace " << path << "\n";
+            close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (length > 0 && base == MAP_FAILED) {
+            std::cerr << "Error: cannot map trace " << path << "\n";
+            return false;
+        }
+        if (length > 0) madvise(base, length, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    const int32_t* data() const {
+        return static_cast<const int32_t*>(base);
+    }
+
+    size_t size() const {
+        return length / sizeof(int32_t);
+    }
+};
+
+// Streams a whitespace-separated text trace in fixed-size chunks, handing
+// each parsed block of pages to fn(pages, count). Memory use is independent
+// of the trace length.
+template <typename Fn>
+bool forEachTextChunk(const std::string& path, Fn fn) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: cannot open trace " << path << "\n";
+        return false;
+    }
+
+    std::vector<char> text(1 << 20);
+    std::vector<int32_t> pages;
+    pages.reserve(text.size() / 2 + 1);
+
+    int64_t value = 0;
+    bool inNumber = false;
+    bool negative = false;
+    size_t got;
+    while ((got = std::fread(text.data(), 1, text.size(), file)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            char c = text[i];
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                inNumber = true;
+            } else if (c == '-' && !inNumber) {
+                negative = true;
+            } else {
+                if (inNumber) pages.push_back(static_cast<int32_t>(negative ? -value : value));
+                value = 0;
+                inNumber = false;
+                negative = false;
+            }
+        }
+        // A number split across chunks stays in value until the next read
+        fn(pages.data(), pages.size());
+        pages.clear();
+    }
+    if (inNumber) {
+        pages.push_back(static_cast<int32_t>(negative ? -value : value));
+        fn(pages.data(), pages.size());
+    }
+    std::fclose(file);
+    return true;
+}
+
+struct ReplayStats {
+    uint64_t references = 0;
+    uint64_t hits = 0;
+
+    uint64_t faults() const {
+        return references - hits;
+    }
+};
+
+// Feeds pages to any cache with a quiet access() and keeps only aggregate
+// counters. Progress goes to stderr every progressEvery references; the
+// check happens once per block, not per access.
+template <typename Cache>
+class TraceReplayer {
+private:
+    Cache& cache;
+    ReplayStats stats;
+    uint64_t progressEvery;
+    uint64_t nextReport;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    void reportProgress() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "[progress] " << stats.references << " refs, hit ratio "
+                  << static_cast<double>(stats.hits) / stats.references << ", "
+                  << stats.references / elapsed.count() / 1e6 << " M refs/sec\n";
+    }
+
+public:
+    TraceReplayer(Cache& c, uint64_t every = 1ull << 28)
+        : cache(c), progressEvery(every), nextReport(every) {}
+
+    void feed(const int32_t* pages, size_t count) {
+        while (count > 0) {
+            size_t block = static_cast<size_t>(std::min<uint64_t>(count, nextReport - stats.references));
+            uint64_t hits = 0;
+            for (size_t i = 0; i < block; i++) {
+                hits += cache.access(pages[i]);
+            }
+            stats.hits += hits;
+            stats.references += block;
+            pages += block;
+            count -= block;
+            if (stats.references == nextReport) {
+                reportProgress();
+                nextReport += progressEvery;
+            }
+        }
+    }
+
+    const ReplayStats& result() const {
+        return stats;
+    }
+
+    double elapsedSeconds() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+};
+
+// Hands the whole trace to fn(pages, count) in one or more blocks
+template <typename Fn>
+bool forEachTraceBlock(const std::string& path, bool text, Fn fn) {
+    if (text) {
+        return forEachTextChunk(path, fn);
+    }
+    MappedTrace trace;
+    if (!trace.open(path)) return false;
+    fn(trace.data(), trace.size());
+    return true;
+}
+
+template <typename Cache>
+int replayTrace(const std::string& path, bool text, int capacity) {
+    if (capacity < 1) {
+        std::cerr << "Error: capacity must be at least 1\n";
+        return 1;
+    }
+    Cache cache(capacity);
+    TraceReplayer<Cache> replayer(cache);
+    bool ok = forEachTraceBlock(path, text, [&](const int32_t* pages, size_t count) {
+        replayer.feed(pages, count);
+    });
+    if (!ok) return 1;
+
+    const ReplayStats& stats = replayer.result();
+    double seconds = replayer.elapsedSeconds();
+    std::cout << "Replayed " << stats.references << " references with capacity " << capacity << "\n";
+    std::cout << "Hits: " << stats.hits << "\n";
+    std::cout << "Total Page Faults: " << stats.faults() << "\n";
+    if (stats.references > 0) {
+        std::cout << "Hit Ratio: " << static_cast<double>(stats.hits) / stats.references << "\n";
+    }
+    std::cout << "Elapsed: " << seconds << " s (" << stats.references / seconds / 1e6 << " M refs/sec)\n";
+    return 0;
+}
+
+// Single-pass LRU stack-distance analysis. A reference's stack distance is
+// the number of distinct pages touched since its previous use, plus one; it
+// hits in every LRU cache at least that large, so one histogram yields the
+// fault count for all capacities at once. A Fenwick tree over access times
+// holds a 1 at each page's most recent access, making every reference
+// O(log n). Times are renumbered whenever the window fills, so memory
+// follows the number of distinct pages rather than the trace length.
+//
+// With maxSampledPages set, only pages whose hash falls below a threshold
+// are tracked (SHARDS, fixed-size variant): distances are scaled by the
+// sampling rate and the threshold drops whenever more than maxSampledPages
+// are tracked, which keeps memory constant on arbitrarily large traces.
+// Scaled distances are binned logarithmically (exact below 64, then 64 bins
+// per power of two) so the histogram stays a fixed size as well.
+class StackDistanceAnalyzer {
+private:
+    static constexpr uint64_t HASH_SPACE = 1ull << 24;
+
+    std::vector<uint32_t> tree; // Fenwick tree over window positions
+    std::unordered_map<int, uint32_t> lastAccess;
+    uint32_t now = 0;
+
+    std::vector<double> histogram; // references per distance bin
+    double coldMisses = 0;
+    uint64_t references = 0;
+
+    size_t maxSampledPages;
+    uint64_t threshold = HASH_SPACE;
+    std::set<std::pair<uint64_t, int>> samples; // tracked pages by hash
+
+    static uint64_t hashPage(int page) {
+        uint64_t x = static_cast<uint32_t>(page) + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return (x ^ (x >> 31)) & (HASH_SPACE - 1);
+    }
+
+    double rate() const {
+        return static_cast<double>(threshold) / HASH_SPACE;
+    }
+
+    void add(uint32_t pos, int delta) {
+        for (size_t i = pos + 1; i < tree.size(); i += i & (0 - i)) tree[i] += delta;
+    }
+
+    // Number of marked positions in [0, pos]
+    uint32_t prefix(uint32_t pos) const {
+        uint32_t sum = 0;
+        for (size_t i = pos + 1; i > 0; i -= i & (0 - i)) sum += tree[i];
+        return sum;
+    }
+
+    // Renumber live pages 0..k-1 in access order and rebuild the tree,
+    // doubling the window if it would stay more than half full
+    void compact() {
+        std::vector<std::pair<uint32_t, int>> order;
+        order.reserve(lastAccess.size());
+        for (const auto& entry : lastAccess) order.push_back({entry.second, entry.first});
+        std::sort(order.begin(), order.end());
+
+        size_t window = tree.size() - 1;
+        if (order.size() * 2 > window) window *= 2;
+        tree.assign(window + 1, 0);
+        for (uint32_t t = 0; t < order.size(); t++) {
+            lastAccess[order[t].second] = t;
+            tree[t + 1] = 1;
+        }
+        for (size_t i = 1; i <= window; i++) {
+            size_t parent = i + (i & (0 - i));
+            if (parent <= window) tree[parent] += tree[i];
+        }
+        now = static_cast<uint32_t>(order.size());
+    }
+
+    static constexpr int LINEAR_BINS = 64;
+
+    // Unsampled runs keep one bin per distance
+    size_t binOf(uint64_t distance) const {
+        if (maxSampledPages == 0 || distance < LINEAR_BINS) return distance;
+        int exponent = 63 - __builtin_clzll(distance); // >= 6
+        return LINEAR_BINS + (exponent - 6) * LINEAR_BINS + ((distance >> (exponent - 6)) & (LINEAR_BINS - 1));
+    }
+
+    // Smallest distance in bin b
+    uint64_t binLow(size_t b) const {
+        if (maxSampledPages == 0 || b < LINEAR_BINS) return b;
+        size_t exponent = (b - LINEAR_BINS) / LINEAR_BINS + 6;
+        return (LINEAR_BINS + (b - LINEAR_BINS) % LINEAR_BINS) << (exponent - 6);
+    }
+
+    uint64_t binHigh(size_t b) const {
+        return binLow(b + 1) - 1;
+    }
+
+    void record(double distance) {
+        size_t bucket = binOf(std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(distance))));
+        if (bucket >= histogram.size()) histogram.resize(std::max(bucket + 1, histogram.size() * 2), 0);
+        histogram[bucket] += 1;
+    }
+
+    // Lower the threshold until at most maxSampledPages are tracked and
+    // rescale what was counted at the old rate
+    void shrinkSample() {
+        double oldRate = rate();
+        while (samples.size() > maxSampledPages) {
+            threshold = std::prev(samples.end())->first;
+            while (!samples.empty() && std::prev(samples.end())->first >= threshold) {
+                int page = std::prev(samples.end())->second;
+                samples.erase(std::prev(samples.end()));
+                auto it = lastAccess.find(page);
+                add(it->second, -1);
+                lastAccess.erase(it);
+            }
+        }
+        double scale = rate() / oldRate;
+        coldMisses *= scale;
+        for (double& count : histogram) count *= scale;
+    }
+
+public:
+    StackDistanceAnalyzer(size_t maxSampled = 0) : tree((1 << 16) + 1, 0), maxSampledPages(maxSampled) {}
+
+    void access(int page) {
+        references++;
+        if (maxSampledPages > 0 && hashPage(page) >= threshold) return;
+
+        if (now + 1 >= tree.size()) compact();
+
+        auto it = lastAccess.find(page);
+        if (it != lastAccess.end()) {
+            uint32_t newer = static_cast<uint32_t>(lastAccess.size()) - prefix(it->second);
+            add(it->second, -1);
+            record((newer + 1) / rate());
+            it->second = now;
+        } else {
+            coldMisses += 1;
+            lastAccess.emplace(page, now);
+            if (maxSampledPages > 0) samples.insert({hashPage(page), page});
+        }
+        add(now, 1);
+        now++;
+
+        if (maxSampledPages > 0 && samples.size() > maxSampledPages) shrinkSample();
+    }
+
+    uint64_t getReferences() const {
+        return references;
+    }
+
+    // Largest capacity that still changes the fault count
+    size_t maxUsefulCapacity() const {
+        size_t last = 0;
+        for (size_t b = 0; b < histogram.size(); b++) {
+            if (histogram[b] > 0) last = binHigh(b);
+        }
+        return std::max<size_t>(last, static_cast<size_t>(std::llround(lastAccess.size() / rate())));
+    }
+
+    // faults[c] = (estimated) page faults of an LRU cache with capacity c
+    std::vector<double> faultsByCapacity(size_t maxCapacity) const {
+        double sampled = coldMisses;
+        for (double count : histogram) sampled += count;
+
+        // SHARDS adjustment: credit the gap between expected and actual
+        // sample size to the shortest distance
+        double adjust = references * rate() - sampled;
+        if (maxSampledPages == 0) adjust = 0;
+        double total = sampled + adjust;
+        double scale = total > 0 ? references / total : 0;
+
+        // A bin that straddles c counts as hits in proportion to the part
+        // of its range at or below c
+        std::vector<double> faults(maxCapacity + 1, static_cast<double>(references));
+        double hits = adjust;
+        size_t b = 1;
+        for (size_t c = 1; c <= maxCapacity; c++) {
+            while (b < histogram.size() && binHigh(b) <= c) hits += histogram[b++];
+            double partial = 0;
+            if (b < histogram.size() && binLow(b) <= c) {
+                partial = histogram[b] * (c - binLow(b) + 1) / (binHigh(b) - binLow(b) + 1);
+            }
+            // The adjustment can overshoot, so keep the estimate a count
+            faults[c] = std::clamp((total - hits - partial) * scale, 0.0, static_cast<double>(references));
+        }
+        return faults;
+    }
+};
+
+int missRatioCurve(const std::string& path, bool text, size_t maxCapacity, size_t maxSampled) {
+    StackDistanceAnalyzer analyzer(maxSampled);
+    bool ok = forEachTraceBlock(path, text, [&](const int32_t* pages, size_t count) {
+        for (size_t i = 0; i < count; i++) analyzer.access(pages[i]);
+    });
+    if (!ok) return 1;
+
+    if (maxCapacity == 0) maxCapacity = analyzer.maxUsefulCapacity();
+    std::vector<double> faults = analyzer.faultsByCapacity(maxCapacity);
+    double references = static_cast<double>(analyzer.getReferences());
+
+    std::cout << "# " << analyzer.getReferences() << " references"
+              << (maxSampled > 0 ? " (sampled, approximate)" : "") << "\n";
+    std::cout << "# capacity page_faults miss_ratio\n";
+    for (size_t c = 1; c <= maxCapacity; c++) {
+        std::cout << c << " " << std::llround(faults[c]) << " "
+                  << (references > 0 ? faults[c] / references : 0) << "\n";
+    }
+    return 0;
+}
+
+// Offline optimal replacement (Belady's MIN): on a fault, evict the
+// resident page whose next use is furthest away. One backward pass gives
+// each reference's next-use index; a max-heap keyed on next use then picks
+// victims in O(log capacity). A page that is never used again is keyed
+// n + position so it sorts after every real next use. Entries whose key is
+// not in the future belong to pages that were hit since and are stale;
+// they are dropped lazily when the heap is compacted.
+uint64_t simulateOPT(const int32_t* pages, size_t n, int capacity) {
+    const uint32_t NEVER = UINT32_MAX;
+    std::vector<uint32_t> nextUse(n);
+    {
+        std::unordered_map<int, uint32_t> seen;
+        for (size_t i = n; i-- > 0;) {
+            auto it = seen.find(pages[i]);
+            if (it == seen.end()) {
+                nextUse[i] = NEVER;
+                seen.emplace(pages[i], static_cast<uint32_t>(i));
+            } else {
+                nextUse[i] = it->second;
+                it->second = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    // pending[j]: a resident page will be referenced next at position j,
+    // so reference j is a hit
+    std::vector<bool> pending(n, false);
+    std::vector<uint64_t> heap;
+    heap.reserve(2 * static_cast<size_t>(capacity) + 1024);
+    size_t resident = 0;
+    uint64_t faults = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (!pending[i]) {
+            faults++;
+            if (resident == static_cast<size_t>(capacity)) {
+                std::pop_heap(heap.begin(), heap.end());
+                uint64_t victim = heap.back();
+                heap.pop_back();
+                if (victim < n) pending[victim] = false;
+            } else {
+                resident++;
+            }
+        }
+
+        uint64_t key = nextUse[i] == NEVER ? n + i : nextUse[i];
+        if (key < n) pending[key] = true;
+        heap.push_back(key);
+        std::push_heap(heap.begin(), heap.end());
+
+        if (heap.size() > 2 * static_cast<size_t>(capacity) + 1024) {
+            heap.erase(std::remove_if(heap.begin(), heap.end(), [i](uint64_t k) { return k <= i; }), heap.end());
+            std::make_heap(heap.begin(), heap.end());
+        }
+    }
+    return faults;
+}
+
+// Replays the same trace through FlatLRUCache and OPT and reports how far
+// LRU is from the optimum
+int compareWithOPT(const std::string& path, bool text, int capacity) {
+    if (capacity < 1) {
+        std::cerr << "Error: capacity must be at least 1\n";
+        return 1;
+    }
+    MappedTrace trace;
+    std::vector<int32_t> loaded;
+    const int32_t* pages;
+    size_t n;
+    if (text) {
+        // OPT needs the whole trace for the backward pass
+        if (!forEachTextChunk(path, [&](const int32_t* p, size_t count) { loaded.insert(loaded.end(), p, p + count); })) {
+            return 1;
+        }
+        pages = loaded.data();
+        n = loaded.size();
+    } else {
+        if (!trace.open(path)) return 1;
+        pages = trace.data();
+        n = trace.size();
+    }
+    if (n >= UINT32_MAX) {
+        std::cerr << "Error: OPT supports traces of fewer than 2^32 references\n";
+        return 1;
+    }
+
+    FlatLRUCache lru(capacity);
+    TraceReplayer<FlatLRUCache> replayer(lru);
+    replayer.feed(pages, n);
+    uint64_t lruFaults = replayer.result().faults();
+    double lruSeconds = replayer.elapsedSeconds();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t optFaults = simulateOPT(pages, n, capacity);
+    std::chrono::duration<double> optSeconds = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Replayed " << n << " references with capacity " << capacity << "\n";
+    std::cout << "LRU Page Faults: " << lruFaults << " (" << lruSeconds << " s)\n";
+    std::cout << "OPT Page Faults: " << optFaults << " (" << optSeconds.count() << " s)\n";
+    std::cout << "Fault Gap: " << lruFaults - optFaults;
+    if (optFaults > 0) {
+        std::cout << " (LRU incurs " << 100.0 * (lruFaults - optFaults) / optFaults << "% more faults)";
+    }
+    std::cout << "\n";
+    return 0;
+}
+
+// Hot set interleaved with long one-time sequential scans, the pattern
+// that flushes a pure LRU
+std::vector<int> makeScanReferenceString(size_t length, int hotPages, int scanLength, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> hot(0, hotPages - 1);
+    std::bernoulli_distribution startScan(0.00005);
+
+    std::vector<int> refs;
+    refs.reserve(length);
+    int nextScanPage = hotPages;
+    while (refs.size() < length) {
+        if (startScan(rng)) {
+            for (int i = 0; i < scanLength && refs.size() < length; i++) refs.push_back(nextScanPage++);
+        } else {
+            refs.push_back(hot(rng));
+        }
+    }
+    return refs;
+}
+
+// Zipf-distributed page popularity with exponent alpha
+std::vector<int> makeZipfReferenceString(size_t length, int pages, double alpha, unsigned seed) {
+    std::vector<double> cdf(pages);
+    double sum = 0;
+    for (int i = 0; i < pages; i++) {
+        sum += 1.0 / std::pow(i + 1, alpha);
+        cdf[i] = sum;
+    }
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0, sum);
+    // Scatter ranks over the page space so popular pages are not adjacent
+    std::vector<int> pageOfRank(pages);
+    for (int i = 0; i < pages; i++) pageOfRank[i] = i;
+    std::shuffle(pageOfRank.begin(), pageOfRank.end(), rng);
+
+    std::vector<int> refs(length);
+    for (auto& r : refs) {
+        r = pageOfRank[std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin()];
+    }
+    return refs;
+}
+
+template <typename Cache>
+void comparePolicy(int capacity, const std::vector<int>& refs) {
+    Cache cache(capacity);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hits = 0;
+    for (int page : refs) hits += cache.access(page);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << std::string(Cache::name()) + std::string(12 - std::string(Cache::name()).size(), ' ')
+              << "hit ratio " << static_cast<double>(hits) / refs.size()
+              << "\t" << elapsed.count() / refs.size() << " ns/op\n";
+}
+
+// Returns false if the trace could not be read
+template <typename Cache>
+bool comparePolicyOnTrace(int capacity, const std::string& path, bool text) {
+    Cache cache(capacity);
+    TraceReplayer<Cache> replayer(cache);
+    bool ok = forEachTraceBlock(path, text, [&](const int32_t* pages, size_t count) { replayer.feed(pages, count); });
+    if (!ok) return false;
+    const ReplayStats& stats = replayer.result();
+
+    std::cout << "  " << std::string(Cache::name()) + std::string(12 - std::string(Cache::name()).size(), ' ')
+              << "hit ratio " << static_cast<double>(stats.hits) / std::max<uint64_t>(stats.references, 1)
+              << "\t" << replayer.elapsedSeconds() * 1e9 / std::max<uint64_t>(stats.references, 1) << " ns/op\n";
+    return true;
+}
+
+void compareAllPolicies(int capacity, const std::vector<int>& refs) {
+    comparePolicy<PolicyCache<LRUPolicy>>(capacity, refs);
+    comparePolicy<PolicyCache<ClockPolicy>>(capacity, refs);
+    comparePolicy<PolicyCache<TwoQPolicy>>(capacity, refs);
+    comparePolicy<PolicyCache<ARCPolicy>>(capacity, refs);
+    comparePolicy<PolicyCache<WTinyLFUPolicy>>(capacity, refs);
+}
+
+int benchmarkPolicies(const std::string& path, bool text, int capacity) {
+    if (!path.empty()) {
+        std::cout << "Trace " << path << ", capacity " << capacity << "\n";
+        bool ok = comparePolicyOnTrace<PolicyCache<LRUPolicy>>(capacity, path, text) &&
+                  comparePolicyOnTrace<PolicyCache<ClockPolicy>>(capacity, path, text) &&
+                  comparePolicyOnTrace<PolicyCache<TwoQPolicy>>(capacity, path, text) &&
+                  comparePolicyOnTrace<PolicyCache<ARCPolicy>>(capacity, path, text) &&
+                  comparePolicyOnTrace<PolicyCache<WTinyLFUPolicy>>(capacity, path, text);
+        return ok ? 0 : 1;
+    }
+
+    const size_t length = 5000000;
+    std::cout << "Hot set with locality, capacity " << capacity << "\n";
+    compareAllPolicies(capacity, makeReferenceString(length, capacity, capacity * 8, 42));
+    std::cout << "Hot set with sequential scans, capacity " << capacity << "\n";
+    compareAllPolicies(capacity, makeScanReferenceString(length, capacity / 2, capacity * 2, 42));
+    std::cout << "Zipf(0.9) over " << capacity * 16 << " pages, capacity " << capacity << "\n";
+    compareAllPolicies(capacity, makeZipfReferenceString(length, capacity * 16, 0.9, 42));
+    return 0;
+}
+
+// Move-only payload for the key/value demo; copying it would not compile
+struct Buffer {
+    std::vector<char> bytes;
+
+    Buffer(size_t size, char fill) : bytes(size, fill) {}
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    Buffer(Buffer&&) = default;
+    Buffer& operator=(Buffer&&) = default;
+};
+
+void keyValueDemo() {
+    std::vector<Buffer> spilled;
+    LRUCache<std::string, Buffer> cache(2, [&](const std::string& key, Buffer& buffer) {
+        std::cout << "Evicting \"" << key << "\", spilling " << buffer.bytes.size() << " bytes\n";
+        spilled.push_back(std::move(buffer));
+    });
+
+    cache.emplace("kernel.img", 1 << 20, 'k');
+    cache.emplace("initrd.img", 1 << 19, 'i');
+
+    // Lookup by string_view, no std::string is built
+    std::string_view name = "kernel.img (boot)";
+    if (Buffer* hit = cache.get(name.substr(0, 10))) {
+        std::cout << "Hit on kernel.img, " << hit->bytes.size() << " bytes\n";
+    }
+
+    cache.put("vmlinuz", Buffer(1 << 18, 'v')); // evicts initrd.img
+    std::cout << "initrd.img cached: " << (cache.contains("initrd.img") ? "yes" : "no") << "\n";
+    std::cout << "Spilled buffers: " << spilled.size() << ", cached entries: " << cache.size() << "\n";
+}
+
+struct PagingConfig {
+    int frames = 4096;
+    int tlbSets = 16;
+    int tlbWays = 4;
+    bool localReplacement = false; // per-process frame quotas instead of one global LRU
+    int prefetch = 0;              // pages after a faulting page to load with it
+    int pageTableLevels = 4;
+    double tlbNs = 1;
+    double memoryNs = 100;
+    double faultNs = 5000000;
+};
+
+// Paging for several processes sharing one physical frame pool. Each
+// reference goes through a set-associative TLB tagged by (pid, page),
+// then the process's page table, then a fault that takes a free frame or
+// evicts one. Replacement is LRUCache-based: one LRU over every resident
+// page (global) or one per process sized to its share of the frames
+// (local). Evictions clear the page table entry and shoot down the TLB.
+class PagingSimulator {
+private:
+    static constexpr uint32_t NO_FRAME = UINT32_MAX;
+
+    struct ProcessStats {
+        uint64_t references = 0;
+        uint64_t tlbHits = 0;
+        uint64_t pageFaults = 0;
+        uint64_t prefetched = 0;
+    };
+
+    struct TLBEntry {
+        uint64_t tag = 0;
+        uint64_t lastUse = 0;
+        bool valid = false;
+    };
+
+    PagingConfig config;
+    std::vector<std::unordered_map<int, uint32_t>> pageTables; // page -> frame
+    std::vector<ProcessStats> stats;
+    std::vector<TLBEntry> tlb; // tlbSets x tlbWays
+    uint64_t tlbClock = 0;
+    std::vector<uint32_t> freeFrames;
+    std::vector<LRUCache<uint64_t, uint32_t>> replacement;
+    double totalNs = 0;
+
+    static uint64_t keyOf(int pid, int page) {
+        return (static_cast<uint64_t>(pid) << 32) | static_cast<uint32_t>(page);
+    }
+
+    TLBEntry* tlbSet(int page) {
+        return &tlb[(static_cast<uint32_t>(page) % config.tlbSets) * config.tlbWays];
+    }
+
+    bool tlbLookup(int page, uint64_t tag) {
+        TLBEntry* set = tlbSet(page);
+        for (int w = 0; w < config.tlbWays; w++) {
+            if (set[w].valid && set[w].tag == tag) {
+                set[w].lastUse = ++tlbClock;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void tlbFill(int page, uint64_t tag) {
+        TLBEntry* set = tlbSet(page);
+        TLBEntry* victim = &set[0];
+        for (int w = 0; w < config.tlbWays; w++) {
+            if (!set[w].valid) {
+                victim = &set[w];
+                break;
+            }
+            if (set[w].lastUse < victim->lastUse) victim = &set[w];
+        }
+        *victim = {tag, ++tlbClock, true};
+    }
+
+    void tlbInvalidate(int page, uint64_t tag) {
+        TLBEntry* set = tlbSet(page);
+        for (int w = 0; w < config.tlbWays; w++) {
+            if (set[w].tag == tag) set[w].valid = false;
+        }
+    }
+
+    LRUCache<uint64_t, uint32_t>& replacementFor(int pid) {
+        return replacement[config.localReplacement ? pid : 0];
+    }
+
+    void evict(uint64_t key, uint32_t frame) {
+        int pid = static_cast<int>(key >> 32);
+        int page = static_cast<int>(static_cast<uint32_t>(key));
+        pageTables[pid].erase(page);
+        tlbInvalidate(page, key);
+        freeFrames.push_back(frame);
+    }
+
+    void load(int pid, int page) {
+        uint64_t key = keyOf(pid, page);
+        // Inserting may evict first, which returns a frame to the pool
+        uint32_t* frame = replacementFor(pid).emplace(key, NO_FRAME).first;
+        *frame = freeFrames.back();
+        freeFrames.pop_back();
+        pageTables[pid][page] = *frame;
+    }
+
+public:
+    PagingSimulator(const PagingConfig& cfg, int processCount)
+        : config(cfg), pageTables(processCount), stats(processCount),
+          tlb(static_cast<size_t>(cfg.tlbSets) * cfg.tlbWays) {
+        for (int f = cfg.frames - 1; f >= 0; f--) freeFrames.push_back(f);
+
+        auto onEvict = [this](const uint64_t& key, uint32_t& frame) { evict(key, frame); };
+        if (config.localReplacement) {
+            replacement.reserve(processCount);
+            for (int p = 0; p < processCount; p++) {
+                // Quotas sum to exactly frames; callers ensure every one is >= 1
+                int quota = cfg.frames / processCount + (p < cfg.frames % processCount ? 1 : 0);
+                replacement.emplace_back(quota, onEvict);
+            }
+        } else {
+            replacement.emplace_back(cfg.frames, onEvict);
+        }
+    }
+
+    // The eviction callbacks point back at this object
+    PagingSimulator(const PagingSimulator&) = delete;
+    PagingSimulator& operator=(const PagingSimulator&) = delete;
+
+    void access(int pid, int page) {
+        ProcessStats& s = stats[pid];
+        uint64_t key = keyOf(pid, page);
+        s.references++;
+        totalNs += config.tlbNs + config.memoryNs;
+
+        if (tlbLookup(page, key)) {
+            s.tlbHits++;
+            replacementFor(pid).get(key);
+            return;
+        }
+
+        totalNs += config.pageTableLevels * config.memoryNs;
+        auto& pageTable = pageTables[pid];
+        if (pageTable.count(page)) {
+            replacementFor(pid).get(key);
+        } else {
+            s.pageFaults++;
+            totalNs += config.faultNs;
+            load(pid, page);
+            // Sequential prefetch rides on the same fault
+            for (int k = 1; k <= config.prefetch; k++) {
+                if (pageTable.count(page + k)) continue;
+                load(pid, page + k);
+                s.prefetched++;
+            }
+            // Keep the faulting page most recent; with a small local quota
+            // prefetching may even have pushed it back out
+            if (pageTable.count(page)) {
+                replacementFor(pid).get(key);
+            } else {
+                load(pid, page);
+            }
+        }
+        tlbFill(page, key);
+    }
+
+    void printReport() const {
+        ProcessStats total;
+        std::cout << std::setw(5) << "PID" << std::setw(14) << "References" << std::setw(12) << "TLB Hit %"
+                  << std::setw(14) << "Page Faults" << std::setw(12) << "Fault %" << std::setw(12) << "Prefetched" << "\n";
+        for (size_t p = 0; p < stats.size(); p++) {
+            const ProcessStats& s = stats[p];
+            if (s.references == 0) continue;
+            std::cout << std::setw(5) << p << std::setw(14) << s.references
+                      << std::setw(12) << 100.0 * s.tlbHits / s.references
+                      << std::setw(14) << s.pageFaults
+                      << std::setw(12) << 100.0 * s.pageFaults / s.references
+                      << std::setw(12) << s.prefetched << "\n";
+            total.references += s.references;
+            total.tlbHits += s.tlbHits;
+            total.pageFaults += s.pageFaults;
+            total.prefetched += s.prefetched;
+        }
+        if (total.references == 0) return;
+        std::cout << "\nReplacement: " << (config.localReplacement ? "local (per-process LRU)" : "global LRU")
+                  << ", " << config.frames << " frames, TLB " << config.tlbSets << "x" << config.tlbWays
+                  << ", prefetch " << config.prefetch << "\n";
+        std::cout << "TLB Hit Rate: " << 100.0 * total.tlbHits / total.references << "%\n";
+        std::cout << "Total Page Faults: " << total.pageFaults << "\n";
+        std::cout << "Average Memory Access Time: " << totalNs / total.references << " ns\n";
+    }
+};
+
+// Interleaved references from several processes: each runs for a burst,
+// mixing sequential sweeps with references into its own hot set
+template <typename Fn>
+void generateProcessMix(int processCount, uint64_t length, int workingSet, Fn fn) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pickProcess(0, processCount - 1);
+    std::uniform_int_distribution<int> hot(0, workingSet - 1);
+    std::uniform_int_distribution<int> far(0, workingSet * 16 - 1);
+    std::bernoulli_distribution sweep(0.002);
+
+    std::vector<int> cursor(processCount, 0);
+    for (uint64_t done = 0; done < length;) {
+        int pid = pickProcess(rng);
+        for (int i = 0; i < 1000 && done < length; i++, done++) {
+            if (cursor[pid] > 0 || sweep(rng)) {
+                // Sweep 64 consecutive pages starting somewhere far away
+                if (cursor[pid] == 0) cursor[pid] = (far(rng) & ~63) | 64;
+                fn(pid, cursor[pid]);
+                cursor[pid] = (cursor[pid] + 1) % 64 == 0 ? 0 : cursor[pid] + 1;
+            } else {
+                fn(pid, hot(rng));
+            }
+        }
+    }
+}
+
+// Replays a trace of (pid, page) pairs, or a synthetic mix when path is empty
+int simulatePaging(const std::string& path, bool text, const PagingConfig& config, int processCount) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t references = 0;
+    if (config.frames < 1) {
+        std::cerr << "Error: --frames must be at least 1\n";
+        return 1;
+    }
+    if (config.tlbSets < 1 || config.tlbWays < 1) {
+        std::cerr << "Error: --tlb sets and ways must be at least 1, got " << config.tlbSets << "x"
+                  << config.tlbWays << "\n";
+        return 1;
+    }
+    // Local replacement gives every process a quota of at least one frame
+    auto frameCheck = [&config](int processes) {
+        if (config.localReplacement && processes > config.frames) {
+            std::cerr << "Error: " << processes << " processes need at least as many frames with --local (have "
+                      << config.frames << ")\n";
+            return false;
+        }
+        return true;
+    };
+
+    if (path.empty()) {
+        if (processCount < 1) {
+            std::cerr << "Error: --procs must be at least 1\n";
+            return 1;
+        }
+        if (!frameCheck(processCount)) return 1;
+        PagingSimulator sim(config, processCount);
+        generateProcessMix(processCount, 20000000, std::max(1, config.frames / processCount / 2), [&](int pid, int page) {
+            sim.access(pid, page);
+        });
+        references = 20000000;
+        sim.printReport();
+    } else {
+        // First pass finds how many processes the trace contains
+        int maxPid = -1;
+        bool odd = false;
+        bool ok = forEachTraceBlock(path, text, [&](const int32_t* values, size_t count) {
+            for (size_t i = 0; i < count; i++, odd = !odd) {
+                if (!odd) maxPid = std::max(maxPid, static_cast<int>(values[i]));
+            }
+        });
+        if (!ok || !frameCheck(maxPid + 1)) return 1;
+
+        PagingSimulator sim(config, maxPid + 1);
+        int pid = 0;
+        bool havePid = false;
+        forEachTraceBlock(path, text, [&](const int32_t* values, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                // Pairs may straddle text chunks, so carry a lone pid over
+                if (!havePid) {
+                    pid = values[i];
+                    havePid = true;
+                    continue;
+                }
+                havePid = false;
+                if (pid < 0) continue;
+                sim.access(pid, values[i]);
+                references++;
+            }
+        });
+        sim.printReport();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Simulated " << references << " references in " << elapsed.count() << " s\n";
+    return 0;
+}
+
+// Writes a synthetic binary trace in the format MappedTrace reads
+int writeTrace(const std::string& path, uint64_t length, int hotPages, int totalPages) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: cannot create trace " << path << "\n";
+        return 1;
+    }
+    const size_t chunk = 1 << 22;
+    for (uint64_t done = 0; done < length; done += chunk) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(chunk, length - done));
+        std::vector<int> refs = makeReferenceString(n, hotPages, totalPages, static_cast<unsigned>(done / chunk));
+        std::fwrite(refs.data(), sizeof(int), n, file);
+    }
+    std::fclose(file);
+    return 0;
+}
+
+bool hasFlag(int argc, char* argv[], const std::string& flag) {
+    for (int i = 2; i < argc; i++) {
+        if (flag == argv[i]) return true;
+    }
+    return false;
+}
+
+// Value of a --name=value option, or fallback
+std::string optionValue(int argc, char* argv[], const std::string& name, const std::string& fallback) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind(name + "=", 0) == 0) return arg.substr(name.size() + 1);
+    }
+    return fallback;
+}
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  lru_cache                                   run the sample simulation\n"
+              << "  lru_cache kv-demo                           generic key/value cache example\n"
+              << "  lru_cache bench                             single-thread refs/sec benchmark\n"
+              << "  lru_cache bench-mt                          multi-thread throughput benchmark\n"
+              << "  lru_cache replay <trace> <capacity> [--text] [--list]\n"
+              << "                                              replay a binary (int32) or text trace\n"
+              << "  lru_cache mrc <trace> [max_capacity] [--text] [--sample=<pages>]\n"
+              << "                                              page faults for every capacity in one pass\n"
+              << "  lru_cache opt <trace> <capacity> [--text]\n"
+              << "                                              LRU faults against the Belady OPT lower bound\n"
+              << "  lru_cache bench-policies [trace] [capacity] [--text]\n"
+              << "                                              hit ratio and ns/op of each eviction policy\n"
+              << "  lru_cache vm [trace] [--frames=N] [--tlb=SETSxWAYS] [--local] [--prefetch=K]\n"
+              << "               [--procs=N] [--text]           paging simulation over (pid, page) pairs\n"
+              << "  lru_cache gen-trace <out> <length> [hot] [total]\n"
+              << "                                              write a synthetic binary trace\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "kv-demo") {
+        keyValueDemo();
+        return 0;
+    }
+    if (mode == "bench") {
+        benchmarkLRU();
+        return 0;
+    }
+    if (mode == "bench-mt") {
+        benchmarkConcurrentLRU();
+        return 0;
+    }
+    if (mode == "replay" && argc >= 4) {
+        bool text = hasFlag(argc, argv, "--text");
+        int capacity = std::stoi(argv[3]);
+        // --list replays through the original std::list based LRUCache
+        if (hasFlag(argc, argv, "--list")) {
+            return replayTrace<LRUCache<>>(argv[2], text, capacity);
+        }
+        return replayTrace<FlatLRUCache>(argv[2], text, capacity);
+    }
+    if (mode == "mrc" && argc >= 3) {
+        size_t maxCapacity = 0;
+        size_t maxSampled = 0;
+        for (int i = 3; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--sample=", 0) == 0) {
+                maxSampled = std::stoull(arg.substr(9));
+            } else if (arg != "--text") {
+                maxCapacity = std::stoull(arg);
+            }
+        }
+        return missRatioCurve(argv[2], hasFlag(argc, argv, "--text"), maxCapacity, maxSampled);
+    }
+    if (mode == "opt" && argc >= 4) {
+        return compareWithOPT(argv[2], hasFlag(argc, argv, "--text"), std::stoi(argv[3]));
+    }
+    if (mode == "bench-policies") {
+        std::string path = argc > 2 && std::string(argv[2]) != "--text" ? argv[2] : "";
+        int capacity = argc > 3 && std::string(argv[3]) != "--text" ? std::stoi(argv[3]) : 4096;
+        return benchmarkPolicies(path, hasFlag(argc, argv, "--text"), capacity);
+    }
+    if (mode == "vm") {
+        PagingConfig config;
+        config.frames = std::stoi(optionValue(argc, argv, "--frames", "4096"));
+        std::string tlb = optionValue(argc, argv, "--tlb", "16x4");
+        config.tlbSets = std::stoi(tlb.substr(0, tlb.find('x')));
+        config.tlbWays = std::stoi(tlb.substr(tlb.find('x') + 1));
+        config.localReplacement = hasFlag(argc, argv, "--local");
+        config.prefetch = std::stoi(optionValue(argc, argv, "--prefetch", "0"));
+        int processCount = std::stoi(optionValue(argc, argv, "--procs", "8"));
+        std::string path = argc > 2 && argv[2][0] != '-' ? argv[2] : "";
+        return simulatePaging(path, hasFlag(argc, argv, "--text"), config, processCount);
+    }
+    if (mode == "gen-trace" && argc >= 4) {
+        int hot = argc > 4 ? std::stoi(argv[4]) : 4096;
+        int total = argc > 5 ? std::stoi(argv[5]) : 65536;
+        return writeTrace(argv[2], std::stoull(argv[3]), hot, total);
+    }
+    if (!mode.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    int cacheCapacity = 4;
+    LRUCache<> lru(cacheCapacity);
+
+    // A sample reference string of page numbers
+    std::vector<int> referenceString = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+
+    std::cout << "Simulating LRU Cache with capacity " << cacheCapacity << "\n";
+    std::cout << "Reference String: ";
+    for(int page : referenceString) std::cout << page << " ";
+    std::cout << "\n---------------------------------------\n\n";
+
+    for (int page : referenceString) {
+        lru.refer(page);
+    }
+
     std::cout << "---------------------------------------\n";
     std::cout << "Simulation Complete.\n";
     std::cout << "Total Page Faults: " << lru.getPageFaults() << "\n";
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,4 +1,8 @@
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
 // The Process struct now includes a priority level
@@ -15,6 +19,76 @@ struct Process {
     int waitingTime = 0;
 };
 
+// Struct-of-arrays process table for large runs. The event-driven
+// algorithms consume remaining[] and fill completion[] in place;
+// turnaround and waiting times are derived from those when reported.
+struct ProcessTable {
+    std::vector<int> id;
+    std::vector<int> arrival;
+    std::vector<int> burst;
+    std::vector<int> priority;
+    std::vector<int> remaining;
+    std::vector<int> completion;
+
+    size_t size() const {
+        return id.size();
+    }
+
+    void reserve(size_t n) {
+        for (auto* column : {&id, &arrival, &burst, &priority, &remaining, &completion}) column->reserve(n);
+    }
+
+    // Heap the columns hold, including unused capacity
+    size_t capacityBytes() const {
+        size_t bytes = 0;
+        for (auto* column : {&id, &arrival, &burst, &priority, &remaining, &completion}) bytes += column->capacity() * sizeof(int);
+        return bytes;
+    }
+
+    void push(const Process& p) {
+        id.push_back(p.id);
+        arrival.push_back(p.arrivalTime);
+        burst.push_back(p.burstTime);
+        priority.push_back(p.priority);
+        remaining.push_back(p.remainingTime);
+        completion.push_back(p.completionTime);
+    }
+
+    // Ready for another run: full bursts left, nothing completed
+    void reset() {
+        std::copy(burst.begin(), burst.end(), remaining.begin());
+        std::fill(completion.begin(), completion.end(), 0);
+    }
+
+    // Overwrites slot i, which streamed runs reuse once its process is done
+    void assign(size_t i, const Process& p) {
+        id[i] = p.id;
+        arrival[i] = p.arrivalTime;
+        burst[i] = p.burstTime;
+        priority[i] = p.priority;
+        remaining[i] = p.remainingTime;
+        completion[i] = p.completionTime;
+    }
+
+    static ProcessTable fromProcesses(const std::vector<Process>& processes) {
+        ProcessTable table;
+        table.reserve(processes.size());
+        for (const Process& p : processes) table.push(p);
+        return table;
+    }
+
+    // Copies the scheduling results back into processes (same order)
+    void writeBack(std::vector<Process>& processes) const {
+        for (size_t i = 0; i < processes.size(); ++i) {
+            Process& p = processes[i];
+            p.remainingTime = remaining[i];
+            p.completionTime = completion[i];
+            p.turnaroundTime = completion[i] - arrival[i];
+            p.waitingTime = p.turnaroundTime - burst[i];
+        }
+    }
+};
+
 // ** UPDATED printResults function **
 void printResults(const std::vector<Process>& processes, const std::string& algorithmName) {
     float totalTurnaroundTime = 0;
@@ -33,12 +107,15 @@ void printResults(const std::vector<Process>& processes, const std::string& algo
     std::cout << std::setw(5) << "PID" << std::setw(10) << "Arrival" << std::setw(10) << "Burst"
               << std::setw(10) << "Priority" << std::setw(15) << "Completion" << std::setw(15) << "Turnaround" << std::setw(10) << "Waiting" << "\n";
 
-    std::vector<Process> sortedProcesses = processes;
-    std::sort(sortedProcesses.begin(), sortedProcesses.end(), [](const Process& a, const Process& b) {
-        return a.id < b.id;
+    // Print in id order through an index permutation rather than a copy
+    std::vector<int> byId(n);
+    std::iota(byId.begin(), byId.end(), 0);
+    std::sort(byId.begin(), byId.end(), [&](int a, int b) {
+        return processes[a].id < processes[b].id;
     });
 
-    for (const auto& p : sortedProcesses) {
+    for (int i : byId) {
+        const Process& p = processes[i];
         std::cout << std::setw(5) << p.id << std::setw(10) << p.arrivalTime << std::setw(10) << p.burstTime;
         
         // Print the priority value or a dash based on the flag
@@ -57,9 +134,143 @@ void printResults(const std::vector<Process>& processes, const std::string& algo
     std::cout << "Average Waiting Time: " << totalWaitingTime / n << "\n";
 }
 
+// Streaming histogram of non-negative values with log-spaced buckets:
+// exact below 16, then 16 buckets per power of two, so a percentile is
+// off by at most 1/16 of its value whatever the number of samples
+class LogHistogram {
+private:
+    static const int SUB_BUCKETS = 16;
+    std::vector<long long> counts = std::vector<long long>(SUB_BUCKETS * 61, 0);
+    long long total = 0;
+    long long largest = 0;
+
+    static int bucketOf(long long v) {
+        if (v < SUB_BUCKETS) return static_cast<int>(v);
+        int exponent = 63 - __builtin_clzll(v); // >= 4
+        int sub = static_cast<int>(v >> (exponent - 4)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+    }
+
+    static long long upperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 4;
+        long long sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << (exponent - 4)) - 1;
+    }
+
+public:
+    void add(long long v) {
+        counts[bucketOf(std::max(0LL, v))]++;
+        total++;
+        largest = std::max(largest, v);
+    }
+
+    long long max() const {
+        return largest;
+    }
+
+    // Upper bound of the bucket holding the q-quantile, capped at the max
+    long long percentile(double q) const {
+        long long rank = static_cast<long long>(std::ceil(q * total));
+        long long seen = 0;
+        for (size_t b = 0; b < counts.size(); ++b) {
+            seen += counts[b];
+            if (seen >= std::max(1LL, rank)) return std::min(upperBound(b), largest);
+        }
+        return largest;
+    }
+};
+
+struct TableMetrics {
+    double avgTurnaround = 0;
+    double avgWaiting = 0;
+    LogHistogram turnaround;
+    LogHistogram waiting;
+};
+
+// Averages come from plain column sums, which the compiler vectorizes;
+// one more pass feeds the histograms
+TableMetrics computeMetrics(const ProcessTable& table) {
+    TableMetrics metrics;
+    size_t n = table.size();
+    if (n == 0) return metrics;
+    const int* completion = table.completion.data();
+    const int* arrival = table.arrival.data();
+    const int* burst = table.burst.data();
+    long long completionSum = 0, arrivalSum = 0, burstSum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        completionSum += completion[i];
+        arrivalSum += arrival[i];
+        burstSum += burst[i];
+    }
+    metrics.avgTurnaround = static_cast<double>(completionSum - arrivalSum) / n;
+    metrics.avgWaiting = static_cast<double>(completionSum - arrivalSum - burstSum) / n;
+    for (size_t i = 0; i < n; ++i) {
+        int turnaround = completion[i] - arrival[i];
+        metrics.turnaround.add(turnaround);
+        metrics.waiting.add(turnaround - burst[i]);
+    }
+    return metrics;
+}
+
+// Averages and tail percentiles
+void printMetrics(const TableMetrics& metrics, std::ostream& out = std::cout) {
+    out << "Average Turnaround Time: " << metrics.avgTurnaround << "\n";
+    out << "Average Waiting Time: " << metrics.avgWaiting << "\n";
+    out << std::setw(12) << "" << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+        << std::setw(12) << "max" << "\n";
+    for (auto [name, histogram] : {std::make_pair("Turnaround", &metrics.turnaround), std::make_pair("Waiting", &metrics.waiting)}) {
+        out << std::left << std::setw(12) << name << std::right << std::setw(12) << histogram->percentile(0.50)
+            << std::setw(12) << histogram->percentile(0.90) << std::setw(12) << histogram->percentile(0.99)
+            << std::setw(12) << histogram->max() << "\n";
+    }
+}
+
+// Results for a process table: optionally the per-process table in id
+// order, then averages and tail percentiles
+void printResults(const ProcessTable& table, const std::string& algorithmName, bool perProcess) {
+    std::cout << "\n--- " << algorithmName << " ---\n";
+    if (perProcess) {
+        std::cout << std::setw(5) << "PID" << std::setw(10) << "Arrival" << std::setw(10) << "Burst"
+                  << std::setw(10) << "Priority" << std::setw(15) << "Completion" << std::setw(15) << "Turnaround" << std::setw(10) << "Waiting" << "\n";
+        std::vector<int> byId(table.size());
+        std::iota(byId.begin(), byId.end(), 0);
+        std::sort(byId.begin(), byId.end(), [&](int a, int b) {
+            return table.id[a] < table.id[b];
+        });
+        for (int i : byId) {
+            int turnaround = table.completion[i] - table.arrival[i];
+            std::cout << std::setw(5) << table.id[i] << std::setw(10) << table.arrival[i] << std::setw(10) << table.burst[i]
+                      << std::setw(10) << table.priority[i] << std::setw(15) << table.completion[i] << std::setw(15)
+                      << turnaround << std::setw(10) << turnaround - table.burst[i] << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    printMetrics(computeMetrics(table));
+}
+
+
+// Tick-by-tick reference implementations. The event-driven versions
+// below must produce exactly the same results and context switch counts;
+// "scheduler verify" checks.
+
+// Counts context switches the way the event engine does: each time the
+// CPU goes to a different process than the last one that ran
+struct SwitchCounter {
+    long long* count;
+    int last = -1;
+
+    void ran(int i) {
+        if (!count || i == last) return;
+        if (last != -1) ++*count;
+        last = i;
+    }
+};
 
 // First Come First Served
-void fcfs(std::vector<Process> processes) {
+std::vector<Process> referenceFCFS(std::vector<Process> processes, long long* switches = nullptr) {
+    SwitchCounter counter{switches};
     int n = processes.size();
     std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
         return a.arrivalTime < b.arrivalTime;
@@ -70,16 +281,18 @@ void fcfs(std::vector<Process> processes) {
         if (currentTime < processes[i].arrivalTime) {
             currentTime = processes[i].arrivalTime;
         }
+        counter.ran(i);
         processes[i].completionTime = currentTime + processes[i].burstTime;
         processes[i].turnaroundTime = processes[i].completionTime - processes[i].arrivalTime;
         processes[i].waitingTime = processes[i].turnaroundTime - processes[i].burstTime;
         currentTime = processes[i].completionTime;
     }
-    printResults(processes, "First Come First Served (FCFS)");
+    return processes;
 }
 
 // Preemptive Shortest Job First (SRTF)
-void preemptiveSJF(std::vector<Process> processes) {
+std::vector<Process> referenceSJF(std::vector<Process> processes, long long* switches = nullptr) {
+    SwitchCounter counter{switches};
     int n = processes.size();
     int completed = 0;
     int currentTime = 0;
@@ -100,6 +313,7 @@ void preemptiveSJF(std::vector<Process> processes) {
         if (shortestJobIndex == -1) {
             currentTime++;
         } else {
+            counter.ran(shortestJobIndex);
             processes[shortestJobIndex].remainingTime--;
             currentTime++;
 
@@ -111,13 +325,14 @@ void preemptiveSJF(std::vector<Process> processes) {
             }
         }
     }
-    printResults(processes, "Preemptive Shortest Job First (SJF/SRTF)");
+    return processes;
 }
 
 // Round Robin
-void roundRobin(std::vector<Process> processes, int quantum) {
+std::vector<Process> referenceRoundRobin(std::vector<Process> processes, int quantum, long long* switches = nullptr) {
+    SwitchCounter counter{switches};
     int n = processes.size();
-    if (n == 0) return;
+    if (n == 0) return processes;
 
     std::queue<int> readyQueue;
     std::vector<bool> inQueue(n, false);
@@ -143,6 +358,7 @@ void roundRobin(std::vector<Process> processes, int quantum) {
 
         int idx = readyQueue.front();
         readyQueue.pop();
+        counter.ran(idx);
         
         int timeToRun = std::min(quantum, processes[idx].remainingTime);
         processes[idx].remainingTime -= timeToRun;
@@ -165,11 +381,12 @@ void roundRobin(std::vector<Process> processes, int quantum) {
             inQueue[idx] = false;
         }
     }
-    printResults(processes, "Round Robin (RR)");
+    return processes;
 }
 
 // Multilevel Queue (3-Level)
-void multilevelQueue(std::vector<Process> processes) {
+std::vector<Process> referenceMLQ(std::vector<Process> processes, long long* switches = nullptr) {
+    SwitchCounter counter{switches};
     int n = processes.size();
     std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
         return a.arrivalTime < b.arrivalTime;
@@ -208,6 +425,7 @@ void multilevelQueue(std::vector<Process> processes) {
                  q_system.push(currentProc);
                  currentProc = q_system.front();
             }
+            counter.ran(currentProc);
             processes[currentProc].remainingTime--;
             timeInQuantum[processes[currentProc].id]++;
             currentTime++;
@@ -227,6 +445,7 @@ void multilevelQueue(std::vector<Process> processes) {
                  q_interactive.push(currentProc);
                  currentProc = q_interactive.front();
             }
+            counter.ran(currentProc);
             processes[currentProc].remainingTime--;
             timeInQuantum[processes[currentProc].id]++;
             currentTime++;
@@ -238,6 +457,7 @@ void multilevelQueue(std::vector<Process> processes) {
         }
         else if (!q_batch.empty()) {
             int currentProc = q_batch.front();
+            counter.ran(currentProc);
             processes[currentProc].remainingTime--;
             currentTime++;
             if (processes[currentProc].remainingTime == 0) {
@@ -255,11 +475,12 @@ void multilevelQueue(std::vector<Process> processes) {
         processes[i].turnaroundTime = processes[i].completionTime - processes[i].arrivalTime;
         processes[i].waitingTime = processes[i].turnaroundTime - processes[i].burstTime;
     }
-    printResults(processes, "Multilevel Queue (MLQ)");
+    return processes;
 }
 
 // Multilevel Feedback Queue (MLFQ)
-void multilevelFeedbackQueue(std::vector<Process> processes) {
+std::vector<Process> referenceMLFQ(std::vector<Process> processes, long long* switches = nullptr) {
+    SwitchCounter counter{switches};
     int n = processes.size();
     
     std::vector<std::queue<int>> queues(3);
@@ -316,6 +537,7 @@ void multilevelFeedbackQueue(std::vector<Process> processes) {
         }
 
         queues[qLevel].pop();
+        counter.ran(currentProc);
         currentTime++;
         processes[currentProc].remainingTime--;
         timeInQuantum[currentProc]++;
@@ -338,11 +560,2846 @@ void multilevelFeedbackQueue(std::vector<Process> processes) {
         processes[i].turnaroundTime = processes[i].completionTime - processes[i].arrivalTime;
         processes[i].waitingTime = processes[i].turnaroundTime - processes[i].burstTime;
     }
-    printResults(processes, "Multilevel Feedback Queue (MLFQ)");
+    return processes;
+}
+
+// Build with -DSCHEDULER_TRACE=1 to compile in the scheduling trace;
+// otherwise the hooks in EventContext are empty
+#ifndef SCHEDULER_TRACE
+#define SCHEDULER_TRACE 0
+#endif
+
+enum class TraceKind : unsigned char { Dispatch, Preempt, Complete, Demote, Boost, QueueLength };
+
+// value is the process id, or the queue length / number of processes
+// boosted; level is the queue level (the new one for a demotion)
+struct TraceEvent {
+    int time;
+    int value;
+    TraceKind kind;
+    unsigned char level;
+};
+
+// Ring of the most recent trace events, overwriting the oldest, plus
+// per-level counters that cover the whole run
+class TraceBuffer {
+private:
+    std::vector<TraceEvent> events;
+    size_t mask;
+    unsigned long long recorded = 0;
+    int sliceStart = 0;
+    int sliceLevel = 0;
+
+public:
+    static const int levels = 3;
+    long long dispatches[levels] = {};
+    long long ticks[levels] = {};
+    long long demotions[levels] = {}; // out of each level
+    long long peakQueue[levels] = {};
+    long long boosts = 0;
+
+    // The capacity is rounded up to a power of two
+    explicit TraceBuffer(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        events.resize(size);
+        mask = size - 1;
+    }
+
+    void record(TraceKind kind, int time, int value, int level) {
+        events[recorded++ & mask] = {time, value, kind, static_cast<unsigned char>(level)};
+        switch (kind) {
+        case TraceKind::Dispatch:
+            dispatches[level]++;
+            sliceStart = time;
+            sliceLevel = level;
+            break;
+        case TraceKind::Preempt:
+        case TraceKind::Complete:
+            ticks[sliceLevel] += time - sliceStart;
+            break;
+        case TraceKind::Demote: demotions[level - 1]++; break;
+        case TraceKind::Boost: boosts += value; break;
+        case TraceKind::QueueLength: peakQueue[level] = std::max<long long>(peakQueue[level], value); break;
+        }
+    }
+
+    unsigned long long size() const { return std::min<unsigned long long>(recorded, events.size()); }
+    unsigned long long dropped() const { return recorded - size(); }
+
+    // Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev, with
+    // a tick shown as a microsecond: one slice per uninterrupted run of a
+    // process, instants for demotions and boosts, a counter per queue level
+    void writeChromeTrace(std::ostream& out, const std::string& name) const {
+        out << "{\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" << name << "\"}}";
+        int open = -1, start = 0, level = 0;
+        for (unsigned long long k = dropped(); k < recorded; ++k) {
+            const TraceEvent& e = events[k & mask];
+            switch (e.kind) {
+            case TraceKind::Dispatch:
+                open = e.value;
+                start = e.time;
+                level = e.level;
+                break;
+            case TraceKind::Preempt:
+            case TraceKind::Complete:
+                // A slice whose start was overwritten is left out
+                if (open == e.value) {
+                    out << ",\n{\"name\":\"P" << open << "\",\"cat\":\"level " << level << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                        << start << ",\"dur\":" << e.time - start << ",\"args\":{\"level\":" << level
+                        << ",\"completed\":" << (e.kind == TraceKind::Complete ? "true" : "false") << "}}";
+                }
+                open = -1;
+                break;
+            case TraceKind::Demote:
+                out << ",\n{\"name\":\"demote P" << e.value << " to level " << int(e.level)
+                    << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":" << e.time << "}";
+                break;
+            case TraceKind::Boost:
+                out << ",\n{\"name\":\"boost " << e.value << " processes\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"ts\":" << e.time << "}";
+                break;
+            case TraceKind::QueueLength:
+                out << ",\n{\"name\":\"level " << int(e.level) << " queue\",\"ph\":\"C\",\"pid\":1,\"ts\":" << e.time
+                    << ",\"args\":{\"length\":" << e.value << "}}";
+                break;
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    void printCounters() const {
+        std::cout << std::setw(7) << "Level" << std::setw(14) << "Dispatches" << std::setw(14) << "Ticks"
+                  << std::setw(14) << "Demotions" << std::setw(14) << "Peak queue" << "\n";
+        for (int level = 0; level < levels; ++level) {
+            std::cout << std::setw(7) << level << std::setw(14) << dispatches[level] << std::setw(14) << ticks[level]
+                      << std::setw(14) << demotions[level] << std::setw(14) << peakQueue[level] << "\n";
+        }
+        std::cout << "Processes boosted by aging: " << boosts << "\n";
+    }
+};
+
+// Heap accounting for the benchmarks: bytes held by the policies' queues
+// and per-process state, live and peak, on the calling thread. Only
+// containers built on CountingAllocator are counted, so the rest of the
+// program (and other threads, as in sweep and real) pays nothing for it.
+thread_local long long heapBytes = 0;
+thread_local long long heapPeak = 0;
+
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        heapBytes += n * sizeof(T);
+        heapPeak = std::max(heapPeak, heapBytes);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        heapBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+template<typename T>
+using CountedVector = std::vector<T, CountingAllocator<T>>;
+template<typename T>
+using CountedDeque = std::deque<T, CountingAllocator<T>>;
+template<typename T>
+using CountedSet = std::set<T, std::less<T>, CountingAllocator<T>>;
+
+// Shared state for the event-driven simulations: the process table and
+// completion bookkeeping. Policies refer to processes by position.
+struct EventContext {
+    ProcessTable& table;
+    int completed = 0;
+    int running = -1;
+    long long contextSwitches = 0;
+    CountedVector<int>* finished = nullptr; // completions, for streamed runs
+#if SCHEDULER_TRACE
+    TraceBuffer* trace = nullptr;
+#endif
+
+    explicit EventContext(ProcessTable& t) : table(t) {}
+
+    // Policies skip their bulk round shortcuts while tracing, so that every
+    // slice is recorded
+    bool tracing() const {
+#if SCHEDULER_TRACE
+        return trace != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    void note(TraceKind kind, int time, int i, int level = 0) {
+#if SCHEDULER_TRACE
+        if (trace) trace->record(kind, time, table.id[i], level);
+#else
+        (void)kind, (void)time, (void)i, (void)level;
+#endif
+    }
+
+    void noteQueue(int time, int level, size_t length) {
+#if SCHEDULER_TRACE
+        if (trace) trace->record(TraceKind::QueueLength, time, static_cast<int>(length), level);
+#else
+        (void)time, (void)level, (void)length;
+#endif
+    }
+
+    void noteBoost(int time, size_t boosted) {
+#if SCHEDULER_TRACE
+        if (trace) trace->record(TraceKind::Boost, time, static_cast<int>(boosted), 0);
+#else
+        (void)time, (void)boosted;
+#endif
+    }
+
+    // Called whenever process i (from queue level) gets the CPU at time
+    // now; switching to a different process than the last one counts as a
+    // context switch
+    void dispatch(int i, int now, int level = 0) {
+        if (running != i) {
+            if (running != -1) contextSwitches++;
+            if (running != -1 && table.remaining[running] > 0) note(TraceKind::Preempt, now, running);
+            note(TraceKind::Dispatch, now, i, level);
+        }
+        running = i;
+    }
+
+    void complete(int i, int time) {
+        table.remaining[i] = 0;
+        table.completion[i] = time;
+        completed++;
+        if (finished) finished->push_back(i);
+        note(TraceKind::Complete, time, i);
+    }
+};
+
+// Discrete-event driver. Admits arrivals in arrival order (ties by
+// position), jumps over idle gaps and otherwise hands the ready set to the
+// policy, whose step(now, nextArrival) runs until its next event (at least
+// one tick) and returns the new time. A table already in arrival order,
+// as generated workloads are, needs no separate admission order.
+template <typename Policy>
+void runEvents(EventContext& ctx, Policy&& policy) {
+    const std::vector<int>& arrival = ctx.table.arrival;
+    int n = arrival.size();
+    CountedVector<int> order;
+    if (!std::is_sorted(arrival.begin(), arrival.end())) {
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return arrival[a] < arrival[b];
+        });
+    }
+    auto nth = [&](int k) { return order.empty() ? k : order[k]; };
+
+    int currentTime = 0;
+    int next = 0;
+    while (ctx.completed < n) {
+        while (next < n && arrival[nth(next)] <= currentTime) {
+            policy.admit(nth(next++));
+        }
+        if (!policy.hasWork()) {
+            currentTime = arrival[nth(next)];
+            continue;
+        }
+        int nextArrival = next < n ? arrival[nth(next)] : INT_MAX;
+        currentTime = policy.step(currentTime, nextArrival);
+    }
+}
+
+// Per-position policy state must cover the table, which streamed runs
+// grow as processes arrive
+template<typename Column>
+void coverTable(Column& column, const ProcessTable& table) {
+    if (column.size() < table.size()) column.resize(table.size());
+}
+
+struct FCFSPolicy {
+    EventContext& ctx;
+    std::queue<int, CountedDeque<int>> ready;
+
+    explicit FCFSPolicy(EventContext& c) : ctx(c) {}
+
+    void admit(int i) { ready.push(i); }
+    bool hasWork() const { return !ready.empty(); }
+
+    int step(int now, int) {
+        ctx.noteQueue(now, 0, ready.size());
+        int i = ready.front();
+        ready.pop();
+        ctx.dispatch(i, now);
+        ctx.complete(i, now + ctx.table.burst[i]);
+        return ctx.table.completion[i];
+    }
+};
+
+// Ready set ordered by (remaining time, position), the same tie-break as
+// the tick loop's first-minimum scan. Only an arrival can preempt, so the
+// shortest job runs until it completes or the next process arrives.
+struct SRTFPolicy {
+    EventContext& ctx;
+    std::priority_queue<std::pair<int, int>, CountedVector<std::pair<int, int>>, std::greater<std::pair<int, int>>> ready;
+
+    explicit SRTFPolicy(EventContext& c) : ctx(c) {}
+
+    void admit(int i) { ready.emplace(ctx.table.remaining[i], i); }
+    bool hasWork() const { return !ready.empty(); }
+
+    int step(int now, int nextArrival) {
+        ctx.noteQueue(now, 0, ready.size());
+        int i = ready.top().second;
+        ready.pop();
+        ctx.dispatch(i, now);
+        int& remaining = ctx.table.remaining[i];
+        int run = std::min(remaining, nextArrival - now);
+        remaining -= run;
+        now += run;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+        } else {
+            ready.emplace(remaining, i);
+        }
+        return now;
+    }
+};
+
+// A preempted process goes back behind anything that arrived during (or
+// at the end of) its slice, so it is requeued at the start of the next
+// step, after the driver has admitted those arrivals.
+struct RoundRobinPolicy {
+    EventContext& ctx;
+    int quantum;
+    CountedDeque<int> ready;
+    int preempted = -1;
+    size_t untilRoundCheck = 0;
+
+    RoundRobinPolicy(EventContext& c, int q) : ctx(c), quantum(q) {}
+
+    void admit(int i) { ready.push_back(i); }
+    bool hasWork() const { return !ready.empty() || preempted != -1; }
+
+    // Whole rounds in which nobody finishes and nothing arrives leave the
+    // queue as it was, so they are skipped in one go. Checked once per round
+    // to keep the scan amortized O(1) per slice.
+    void skipRounds(int& now, int nextArrival) {
+        if (ctx.tracing()) return;
+        long long round = static_cast<long long>(quantum) * ready.size();
+        long long rounds = nextArrival == INT_MAX ? LLONG_MAX : (nextArrival - now - 1LL) / round;
+        for (int i : ready) {
+            if (rounds == 0) break;
+            rounds = std::min<long long>(rounds, (ctx.table.remaining[i] - 1) / quantum);
+        }
+        if (rounds <= 0) return;
+        for (int i : ready) {
+            ctx.dispatch(i, now);
+            ctx.table.remaining[i] -= static_cast<int>(rounds * quantum);
+        }
+        if (ready.size() > 1) ctx.contextSwitches += (rounds - 1) * static_cast<long long>(ready.size());
+        now += static_cast<int>(rounds * round);
+    }
+
+    int step(int now, int nextArrival) {
+        if (preempted != -1) {
+            ready.push_back(preempted);
+            preempted = -1;
+        }
+        if (untilRoundCheck == 0) {
+            skipRounds(now, nextArrival);
+            untilRoundCheck = ready.size();
+        }
+        untilRoundCheck--;
+        ctx.noteQueue(now, 0, ready.size());
+
+        int i = ready.front();
+        ready.pop_front();
+        ctx.dispatch(i, now);
+        int& remaining = ctx.table.remaining[i];
+        int run = std::min(quantum, remaining);
+        remaining -= run;
+        now += run;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+        } else {
+            preempted = i;
+        }
+        return now;
+    }
+};
+
+// Same rules as the tick loop: an expired quantum is only noticed (and the
+// process rotated to the back) the next time its level is served, and a
+// process preempted by a higher level keeps the rest of its quantum. Any
+// arrival may preempt, so runs stop at the next arrival.
+struct MultilevelQueuePolicy {
+    EventContext& ctx;
+    CountedDeque<int> levels[3]; // system: RR, interactive: RR, batch: FCFS
+    int quanta[2];
+    CountedVector<int> timeInQuantum;
+
+    MultilevelQueuePolicy(EventContext& c, int systemQuantum, int interactiveQuantum)
+        : ctx(c), quanta{systemQuantum, interactiveQuantum}, timeInQuantum(c.table.size(), 0) {}
+
+    void admit(int i) {
+        coverTable(timeInQuantum, ctx.table);
+        timeInQuantum[i] = 0;
+        int priority = ctx.table.priority[i];
+        levels[priority == 1 ? 0 : priority == 2 ? 1 : 2].push_back(i);
+    }
+    bool hasWork() const { return !levels[0].empty() || !levels[1].empty() || !levels[2].empty(); }
+
+    int step(int now, int nextArrival) {
+        for (int l = 0; l < 3; l++) ctx.noteQueue(now, l, levels[l].size());
+        int level = !levels[0].empty() ? 0 : !levels[1].empty() ? 1 : 2;
+        CountedDeque<int>& q = levels[level];
+        int i = q.front();
+        int run;
+        if (level == 2) {
+            run = std::min(ctx.table.remaining[i], nextArrival - now);
+        } else if (q.size() == 1) {
+            // Rotating a lone process changes nothing but its counter
+            int quantum = quanta[level];
+            run = std::min(ctx.table.remaining[i], nextArrival - now);
+            timeInQuantum[i] = (timeInQuantum[i] % quantum + run - 1) % quantum + 1;
+        } else {
+            int quantum = quanta[level];
+            if (timeInQuantum[i] == quantum) {
+                timeInQuantum[i] = 0;
+                q.pop_front();
+                q.push_back(i);
+                i = q.front();
+            }
+            run = std::min({ctx.table.remaining[i], quantum - timeInQuantum[i], nextArrival - now});
+            timeInQuantum[i] += run;
+        }
+
+        ctx.dispatch(i, now, level);
+        int& remaining = ctx.table.remaining[i];
+        remaining -= run;
+        now += run;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+            q.pop_front();
+        }
+        return now;
+    }
+};
+
+// The tick loop sends the running process to the back of its level after
+// every tick, so each level is served round-robin one tick at a time, and
+// every agingPeriod ticks the lower levels move back to the top. Whole
+// rounds in which nobody finishes or is demoted and no arrival or aging
+// intervenes leave the levels unchanged and are taken at once, and aging
+// points with nobody below the top level are run straight past.
+//
+// Limitation: a round that demotes anyone, and any round wider than the
+// distance to the next aging point while a lower level is occupied, is
+// still simulated one tick (one O(1) event) at a time. Under sustained
+// load, where every process passes through a demotion round once per top
+// quantum, cost stays proportional to the total burst time rather than to
+// the number of processes as it is for the other policies.
+struct FeedbackQueuePolicy {
+    EventContext& ctx;
+    CountedDeque<int> levels[3];
+    int quanta[3];
+    int agingPeriod;
+    CountedVector<int> timeInQuantum;
+    size_t untilRoundCheck = 0;
+
+    FeedbackQueuePolicy(EventContext& c, int topQuantum, int middleQuantum, int aging)
+        : ctx(c), quanta{topQuantum, middleQuantum, -1}, agingPeriod(aging), timeInQuantum(c.table.size(), 0) {}
+
+    void admit(int i) {
+        coverTable(timeInQuantum, ctx.table);
+        timeInQuantum[i] = 0;
+        levels[0].push_back(i);
+    }
+    bool hasWork() const { return !levels[0].empty() || !levels[1].empty() || !levels[2].empty(); }
+
+    void age(int now) {
+        ctx.noteBoost(now, levels[1].size() + levels[2].size());
+        for (int level = 1; level < 3; level++) {
+            for (int i : levels[level]) {
+                levels[0].push_back(i);
+                timeInQuantum[i] = 0;
+            }
+            levels[level].clear();
+        }
+    }
+
+    bool skipRounds(int& now, int until, int level) {
+        if (ctx.tracing()) return false;
+        CountedDeque<int>& q = levels[level];
+        long long rounds = (until - static_cast<long long>(now)) / static_cast<long long>(q.size());
+        for (int i : q) {
+            if (rounds == 0) break;
+            rounds = std::min<long long>(rounds, ctx.table.remaining[i] - 1);
+            if (level < 2) rounds = std::min<long long>(rounds, quanta[level] - timeInQuantum[i] - 1);
+        }
+        if (rounds <= 0) return false;
+        for (int i : q) {
+            ctx.dispatch(i, now, level);
+            ctx.table.remaining[i] -= static_cast<int>(rounds);
+            timeInQuantum[i] += static_cast<int>(rounds);
+        }
+        if (q.size() > 1) ctx.contextSwitches += (rounds - 1) * static_cast<long long>(q.size());
+        now += static_cast<int>(rounds * q.size());
+        return true;
+    }
+
+    // Aging moves nobody while the lower levels are empty; traced runs still
+    // stop there so that every boost is recorded
+    bool agingIsNoop() const { return levels[1].empty() && levels[2].empty() && !ctx.tracing(); }
+
+    // Runs up to the next arrival, or the next aging point that has anyone
+    // to boost, whichever comes first
+    int step(int now, int nextArrival) {
+        if (now > 0 && now % agingPeriod == 0) {
+            age(now);
+        }
+        for (int l = 0; l < 3; l++) ctx.noteQueue(now, l, levels[l].size());
+        int start = now;
+        while (now < nextArrival && hasWork()) {
+            if (now != start && now % agingPeriod == 0 && !agingIsNoop()) break;
+            int until = agingIsNoop() ? nextArrival
+                                      : static_cast<int>(std::min<long long>(nextArrival, (now / agingPeriod + 1LL) * agingPeriod));
+            int level = !levels[0].empty() ? 0 : !levels[1].empty() ? 1 : 2;
+            CountedDeque<int>& q = levels[level];
+            if (untilRoundCheck == 0) {
+                untilRoundCheck = q.size();
+                if (skipRounds(now, until, level)) continue;
+            }
+            untilRoundCheck--;
+
+            int i = q.front();
+            q.pop_front();
+            ctx.dispatch(i, now, level);
+            int& remaining = ctx.table.remaining[i];
+            now++;
+            remaining--;
+            timeInQuantum[i]++;
+            if (remaining == 0) {
+                ctx.complete(i, now);
+            } else if (level < 2 && timeInQuantum[i] >= quanta[level]) {
+                ctx.note(TraceKind::Demote, now, i, level + 1);
+                levels[level + 1].push_back(i);
+                timeInQuantum[i] = 0;
+            } else {
+                q.push_back(i);
+            }
+        }
+        return now;
+    }
+};
+
+// Share weights for the fair-share policies, Linux's nice -5 / 0 / 5 for
+// system / interactive / batch
+int shareWeight(int priority) {
+    return priority == 1 ? 3121 : priority == 2 ? 1024 : 335;
+}
+
+// CFS: the ready set is a red-black tree ordered by virtual runtime, which
+// advances at 1024 / weight per tick. The leftmost process gets a slice of
+// the scheduling period proportional to its weight; a newcomer (placed at
+// the tree's minimum) only preempts once it is more than the wakeup
+// granularity behind the running process.
+struct CFSPolicy {
+    EventContext& ctx;
+    int latency, minGranularity, wakeupGranularity;
+    CountedSet<std::pair<double, int>> tree; // (vruntime, position)
+    CountedVector<double> vruntime;
+    double minVruntime = 0;
+    long long totalWeight = 0;
+    int current = -1;
+    int sliceLeft = 0;
+
+    CFSPolicy(EventContext& c, int lat, int minGran, int wakeupGran)
+        : ctx(c), latency(lat), minGranularity(minGran), wakeupGranularity(wakeupGran), vruntime(c.table.size(), 0) {}
+
+    void admit(int i) {
+        coverTable(vruntime, ctx.table);
+        vruntime[i] = minVruntime;
+        tree.emplace(vruntime[i], i);
+        totalWeight += shareWeight(ctx.table.priority[i]);
+    }
+    bool hasWork() const { return !tree.empty(); }
+
+    int step(int now, int nextArrival) {
+        ctx.noteQueue(now, 0, tree.size());
+        int i = tree.begin()->second;
+        if (current != -1 && i != current && sliceLeft > 0 &&
+            vruntime[current] - vruntime[i] <= wakeupGranularity * 1024.0 / shareWeight(ctx.table.priority[i])) {
+            i = current;
+        }
+        int weight = shareWeight(ctx.table.priority[i]);
+        if (i != current || sliceLeft <= 0) {
+            long long period = std::max<long long>(latency, static_cast<long long>(tree.size()) * minGranularity);
+            sliceLeft = static_cast<int>(std::max<long long>(minGranularity, period * weight / totalWeight));
+            current = i;
+        }
+        tree.erase({vruntime[i], i});
+
+        ctx.dispatch(i, now);
+        int& remaining = ctx.table.remaining[i];
+        int run = std::min({remaining, sliceLeft, nextArrival - now});
+        remaining -= run;
+        sliceLeft -= run;
+        now += run;
+        vruntime[i] += run * 1024.0 / weight;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+            totalWeight -= weight;
+            current = -1;
+        } else {
+            tree.emplace(vruntime[i], i);
+        }
+        if (!tree.empty()) minVruntime = std::max(minVruntime, tree.begin()->first);
+        return now;
+    }
+};
+
+// EEVDF: every process requests slices of the same length; a request's
+// virtual deadline is its virtual start plus slice * 1024 / weight. Among
+// the eligible processes (virtual runtime no later than the weighted
+// average V, i.e. not owed less than nothing) the earliest deadline runs.
+// Eligible processes sit in a set by deadline and the rest in a set by
+// virtual runtime, promoted as V passes them; a process left behind in the
+// deadline set when V falls (someone ahead of it finished) is moved back
+// when it reaches the front.
+//
+// Virtual time is kept in integers scaled by 3121 * 335, so that every
+// weight's per-tick advance of 1024 / weight is exact. As with Linux's min_vruntime and
+// avg_vruntime, V is kept as weighted lags against a base that follows it,
+// which keeps the sum small; eligibility is then an exact comparison
+// however long the run.
+struct EEVDFPolicy {
+    // Divisible by every share weight
+    static constexpr long long unit = 3121LL * 1024 * 335;
+
+    EventContext& ctx;
+    int slice;
+    CountedSet<std::pair<long long, int>> eligible; // (deadline, position)
+    CountedSet<std::pair<long long, int>> waiting;  // (vruntime, position)
+    CountedVector<long long> vruntime, deadline;
+    CountedVector<int> used; // ticks of the current request already served
+    long long base = 0;
+    long long weightedLag = 0; // sum of weight * (vruntime - base)
+    long long totalWeight = 0;
+
+    EEVDFPolicy(EventContext& c, int s)
+        : ctx(c), slice(s), vruntime(c.table.size(), 0), deadline(c.table.size(), 0), used(c.table.size(), 0) {}
+
+    long long request(int weight) const { return slice * (unit / weight); }
+
+    // vruntime <= V, without dividing
+    bool isEligible(int i) const { return (vruntime[i] - base) * totalWeight <= weightedLag; }
+
+    // Moves the base up to V (rounded toward it), so lags stay small
+    void rebase() {
+        if (totalWeight == 0) {
+            weightedLag = 0;
+            return;
+        }
+        long long shift = weightedLag / totalWeight;
+        base += shift;
+        weightedLag -= shift * totalWeight;
+    }
+
+    void insert(int i) {
+        if (isEligible(i)) {
+            eligible.emplace(deadline[i], i);
+        } else {
+            waiting.emplace(vruntime[i], i);
+        }
+    }
+
+    // Joins at V (rounded down), i.e. with zero lag
+    void admit(int i) {
+        coverTable(vruntime, ctx.table);
+        coverTable(deadline, ctx.table);
+        coverTable(used, ctx.table);
+        int weight = shareWeight(ctx.table.priority[i]);
+        rebase();
+        vruntime[i] = weightedLag < 0 ? base - 1 : base;
+        used[i] = 0;
+        deadline[i] = vruntime[i] + request(weight);
+        weightedLag += weight * (vruntime[i] - base);
+        totalWeight += weight;
+        eligible.emplace(deadline[i], i);
+    }
+    bool hasWork() const { return !eligible.empty() || !waiting.empty(); }
+
+    int step(int now, int nextArrival) {
+        ctx.noteQueue(now, 0, eligible.size() + waiting.size());
+        rebase();
+        while (!waiting.empty() && isEligible(waiting.begin()->second)) {
+            int j = waiting.begin()->second;
+            waiting.erase(waiting.begin());
+            eligible.emplace(deadline[j], j);
+        }
+        while (!eligible.empty() && !isEligible(eligible.begin()->second)) {
+            int j = eligible.begin()->second;
+            eligible.erase(eligible.begin());
+            waiting.emplace(vruntime[j], j);
+        }
+        // The minimum never exceeds the average, so someone is eligible
+        int i = eligible.begin()->second;
+        eligible.erase(eligible.begin());
+
+        ctx.dispatch(i, now);
+        int weight = shareWeight(ctx.table.priority[i]);
+        int& remaining = ctx.table.remaining[i];
+        int run = std::min({remaining, slice - used[i], nextArrival - now});
+        remaining -= run;
+        used[i] += run;
+        now += run;
+        vruntime[i] += run * (unit / weight);
+        weightedLag += run * unit;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+            totalWeight -= weight;
+            weightedLag -= weight * (vruntime[i] - base);
+        } else {
+            if (used[i] == slice) {
+                used[i] = 0;
+                deadline[i] = vruntime[i] + request(weight);
+            }
+            insert(i);
+        }
+        return now;
+    }
+};
+
+// Stride scheduling: each process holds tickets (its share weight) and a
+// stride inversely proportional to them; the lowest pass runs a quantum
+// and advances its pass by the stride, prorated for a shorter run. A
+// newcomer starts one stride past the lowest ready pass, or past the pass
+// of the last dispatch when nothing is ready.
+struct StridePolicy {
+    static constexpr long long stride1 = 1 << 20;
+
+    EventContext& ctx;
+    int quantum;
+    CountedSet<std::pair<long long, int>> ready; // (pass, position)
+    CountedVector<long long> pass;
+    long long globalPass = 0;
+
+    StridePolicy(EventContext& c, int q) : ctx(c), quantum(q), pass(c.table.size(), 0) {}
+
+    long long stride(int i) const { return stride1 / shareWeight(ctx.table.priority[i]); }
+
+    void admit(int i) {
+        coverTable(pass, ctx.table);
+        pass[i] = (ready.empty() ? globalPass : ready.begin()->first) + stride(i);
+        ready.emplace(pass[i], i);
+    }
+    bool hasWork() const { return !ready.empty(); }
+
+    int step(int now, int) {
+        ctx.noteQueue(now, 0, ready.size());
+        int i = ready.begin()->second;
+        ready.erase(ready.begin());
+        globalPass = pass[i];
+        ctx.dispatch(i, now);
+        int& remaining = ctx.table.remaining[i];
+        int run = std::min(quantum, remaining);
+        remaining -= run;
+        now += run;
+        pass[i] += stride(i) * run / quantum;
+        if (remaining == 0) {
+            ctx.complete(i, now);
+        } else {
+            ready.emplace(pass[i], i);
+        }
+        return now;
+    }
+};
+
+enum class Algorithm { FCFS, SRTF, RR, MLQ, MLFQ, CFS, EEVDF, Stride };
+
+// Every algorithm, in the order the tools report them
+const std::vector<Algorithm> allAlgorithms = {Algorithm::FCFS, Algorithm::SRTF, Algorithm::RR,    Algorithm::MLQ,
+                                              Algorithm::MLFQ, Algorithm::CFS,  Algorithm::EEVDF, Algorithm::Stride};
+
+// Tunable parameters; the defaults are what main() has always used
+struct SchedulerParams {
+    int rrQuantum = 4;
+    int mlqQuanta[2] = {4, 8};  // system, interactive
+    int mlfqQuanta[2] = {8, 16}; // top, middle
+    int agingPeriod = 50;
+    int cfsLatency = 24;          // target period in which everyone runs
+    int cfsMinGranularity = 3;    // shortest slice
+    int cfsWakeupGranularity = 4; // lead a newcomer needs to preempt
+    int eevdfSlice = 4;
+    int strideQuantum = 4;
+};
+
+struct SimulationResult {
+    std::vector<Process> processes;
+    long long contextSwitches = 0;
+};
+
+const char* algorithmName(Algorithm algorithm) {
+    const char* names[] = {"FCFS", "SRTF", "RR", "MLQ", "MLFQ", "CFS", "EEVDF", "Stride"};
+    return names[static_cast<int>(algorithm)];
+}
+
+bool parseAlgorithm(const std::string& name, Algorithm& algorithm) {
+    for (Algorithm a : allAlgorithms) {
+        if (name == algorithmName(a)) {
+            algorithm = a;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Builds the policy for algorithm and hands it to run
+template<typename Run>
+void withPolicy(Algorithm algorithm, EventContext& ctx, const SchedulerParams& params, Run&& run) {
+    switch (algorithm) {
+    case Algorithm::FCFS: run(FCFSPolicy(ctx)); break;
+    case Algorithm::SRTF: run(SRTFPolicy(ctx)); break;
+    case Algorithm::RR: run(RoundRobinPolicy(ctx, params.rrQuantum)); break;
+    case Algorithm::MLQ: run(MultilevelQueuePolicy(ctx, params.mlqQuanta[0], params.mlqQuanta[1])); break;
+    case Algorithm::MLFQ: run(FeedbackQueuePolicy(ctx, params.mlfqQuanta[0], params.mlfqQuanta[1], params.agingPeriod)); break;
+    case Algorithm::CFS: run(CFSPolicy(ctx, params.cfsLatency, params.cfsMinGranularity, params.cfsWakeupGranularity)); break;
+    case Algorithm::EEVDF: run(EEVDFPolicy(ctx, params.eevdfSlice)); break;
+    case Algorithm::Stride: run(StridePolicy(ctx, params.strideQuantum)); break;
+    }
+}
+
+// Runs algorithm over the table in place and returns the number of
+// context switches. A trace buffer is only filled in tracing builds.
+long long simulateTable(Algorithm algorithm, ProcessTable& table, const SchedulerParams& params = SchedulerParams(),
+                        TraceBuffer* trace = nullptr) {
+    EventContext ctx(table);
+#if SCHEDULER_TRACE
+    ctx.trace = trace;
+#else
+    (void)trace;
+#endif
+    withPolicy(algorithm, ctx, params, [&ctx](auto&& policy) { runEvents(ctx, policy); });
+    return ctx.contextSwitches;
 }
 
+// Streamed runs: processes come from source (anything with
+// bool next(Process&), in arrival order) as the clock reaches them and hold
+// a table slot only while live. Each completed process is handed to
+// retire(table, slot) and the slot reused, so memory follows the number of
+// live processes rather than the length of the trace. Positions no longer
+// follow arrival order, so SRTF and the fair-share policies may break ties
+// between equal keys differently than a whole-table run; the queue-based
+// policies give identical results.
+template<typename Source, typename Retire, typename Policy>
+void streamEvents(EventContext& ctx, Source& source, Retire& retire, Policy&& policy) {
+    ProcessTable& table = ctx.table;
+    CountedVector<int> finished, freeSlots;
+    ctx.finished = &finished;
+    // The slot of the last process to run stays taken until another one is
+    // dispatched, so a newcomer in it cannot pass for the same process
+    int held = -1;
+    Process next;
+    bool more = source.next(next);
+    int now = 0;
+    while (more || policy.hasWork()) {
+        while (more && next.arrivalTime <= now) {
+            next.remainingTime = next.burstTime;
+            next.completionTime = 0;
+            int i;
+            if (freeSlots.empty()) {
+                i = table.size();
+                table.push(next);
+            } else {
+                i = freeSlots.back();
+                freeSlots.pop_back();
+                table.assign(i, next);
+            }
+            policy.admit(i);
+            more = source.next(next);
+        }
+        if (!policy.hasWork()) {
+            now = next.arrivalTime;
+            continue;
+        }
+        now = policy.step(now, more ? next.arrivalTime : INT_MAX);
+
+        if (held != -1 && held != ctx.running) {
+            freeSlots.push_back(held);
+            held = -1;
+        }
+        for (int i : finished) {
+            retire(table, i);
+            if (i != ctx.running) {
+                freeSlots.push_back(i);
+                continue;
+            }
+            if (held != -1) freeSlots.push_back(held);
+            held = i;
+        }
+        finished.clear();
+    }
+    ctx.finished = nullptr;
+}
+
+// Streams source through algorithm; returns the number of context
+// switches. table ends up holding the last processes in each slot.
+template<typename Source, typename Retire>
+long long simulateStream(Algorithm algorithm, Source& source, Retire&& retire, ProcessTable& table,
+                         const SchedulerParams& params = SchedulerParams()) {
+    EventContext ctx(table);
+    withPolicy(algorithm, ctx, params, [&](auto&& policy) { streamEvents(ctx, source, retire, policy); });
+    return ctx.contextSwitches;
+}
+
+SimulationResult simulate(Algorithm algorithm, std::vector<Process> processes, const SchedulerParams& params = SchedulerParams()) {
+    // Everything but SRTF works on the processes sorted by arrival, as the
+    // tick loops did
+    if (algorithm != Algorithm::SRTF) {
+        std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+            return a.arrivalTime < b.arrivalTime;
+        });
+    }
+    ProcessTable table = ProcessTable::fromProcesses(processes);
+    long long switches = simulateTable(algorithm, table, params);
+    table.writeBack(processes);
+    return {std::move(processes), switches};
+}
+
+std::vector<Process> simulateFCFS(std::vector<Process> processes) {
+    return simulate(Algorithm::FCFS, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateSJF(std::vector<Process> processes) {
+    return simulate(Algorithm::SRTF, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateRoundRobin(std::vector<Process> processes, int quantum) {
+    SchedulerParams params;
+    params.rrQuantum = quantum;
+    return simulate(Algorithm::RR, std::move(processes), params).processes;
+}
+
+std::vector<Process> simulateMLQ(std::vector<Process> processes) {
+    return simulate(Algorithm::MLQ, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateMLFQ(std::vector<Process> processes) {
+    return simulate(Algorithm::MLFQ, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateCFS(std::vector<Process> processes) {
+    return simulate(Algorithm::CFS, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateEEVDF(std::vector<Process> processes) {
+    return simulate(Algorithm::EEVDF, std::move(processes)).processes;
+}
+
+std::vector<Process> simulateStride(std::vector<Process> processes) {
+    return simulate(Algorithm::Stride, std::move(processes)).processes;
+}
+
+void fcfs(std::vector<Process> processes) {
+    printResults(simulateFCFS(std::move(processes)), "First Come First Served (FCFS)");
+}
+
+void preemptiveSJF(std::vector<Process> processes) {
+    printResults(simulateSJF(std::move(processes)), "Preemptive Shortest Job First (SJF/SRTF)");
+}
+
+void roundRobin(std::vector<Process> processes, int quantum) {
+    if (processes.empty()) return;
+    printResults(simulateRoundRobin(std::move(processes), quantum), "Round Robin (RR)");
+}
+
+void multilevelQueue(std::vector<Process> processes) {
+    printResults(simulateMLQ(std::move(processes)), "Multilevel Queue (MLQ)");
+}
+
+void multilevelFeedbackQueue(std::vector<Process> processes) {
+    printResults(simulateMLFQ(std::move(processes)), "Multilevel Feedback Queue (MLFQ)");
+}
+
+void completelyFair(std::vector<Process> processes) {
+    printResults(simulateCFS(std::move(processes)), "Completely Fair Scheduler (CFS)");
+}
+
+void earliestEligibleDeadline(std::vector<Process> processes) {
+    printResults(simulateEEVDF(std::move(processes)), "Earliest Eligible Virtual Deadline First (EEVDF)");
+}
+
+void strideScheduling(std::vector<Process> processes) {
+    printResults(simulateStride(std::move(processes)), "Stride Scheduling");
+}
+
+bool sameResults(const std::vector<Process>& a, const std::vector<Process>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id != b[i].id || a[i].completionTime != b[i].completionTime ||
+            a[i].turnaroundTime != b[i].turnaroundTime || a[i].waitingTime != b[i].waitingTime) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Small random workload for the verify rounds: up to 12 processes with
+// shuffled ids, crowded arrivals and short or long bursts
+std::vector<Process> randomWorkload(std::mt19937& rng, bool shortBursts) {
+    int n = 1 + rng() % 12;
+    int maxArrival = 1 + rng() % 60;
+    int maxBurst = 1 + rng() % (shortBursts ? 8 : 60);
+    std::vector<int> ids(n);
+    std::iota(ids.begin(), ids.end(), 1);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    std::vector<Process> processes;
+    for (int i = 0; i < n; ++i) {
+        Process p{ids[i], static_cast<int>(rng() % maxArrival), 1 + static_cast<int>(rng() % maxBurst),
+                  1 + static_cast<int>(rng() % 3), 0};
+        p.remainingTime = p.burstTime;
+        processes.push_back(p);
+    }
+    return processes;
+}
+
+// Random small workloads through both the tick-by-tick and the event-driven
+// version of every algorithm; the results must match exactly
+int verifyEventEngine(int rounds) {
+    std::mt19937 rng(7);
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<Process> processes = randomWorkload(rng, r % 2);
+        int n = processes.size();
+        int quantum = 1 + rng() % 6;
+
+        const Algorithm ticked[] = {Algorithm::FCFS, Algorithm::SRTF, Algorithm::RR, Algorithm::MLQ, Algorithm::MLFQ};
+        long long referenceSwitches[5] = {};
+        const std::vector<Process> references[] = {
+            referenceFCFS(processes, &referenceSwitches[0]),
+            referenceSJF(processes, &referenceSwitches[1]),
+            referenceRoundRobin(processes, quantum, &referenceSwitches[2]),
+            referenceMLQ(processes, &referenceSwitches[3]),
+            referenceMLFQ(processes, &referenceSwitches[4]),
+        };
+        SchedulerParams tickParams;
+        tickParams.rrQuantum = quantum;
+        for (int k = 0; k < 5; ++k) {
+            SimulationResult result = simulate(ticked[k], processes, tickParams);
+            if (!sameResults(references[k], result.processes)) {
+                std::cout << "FAILED: " << algorithmName(ticked[k]) << " differs from the tick-by-tick version in round " << r << "\n";
+                return 1;
+            }
+            if (result.contextSwitches != referenceSwitches[k]) {
+                std::cout << "FAILED: " << algorithmName(ticked[k]) << " counted " << result.contextSwitches
+                          << " context switches, the tick-by-tick version " << referenceSwitches[k] << ", in round " << r << "\n";
+                return 1;
+            }
+        }
+
+        // The fair-share policies have no tick loop to compare with, but
+        // like every policy here they never idle with work waiting, so the
+        // CPU must finish at the same time as under FCFS
+        std::vector<Process> reference = simulateFCFS(processes);
+        int makespan = 0;
+        for (const Process& p : reference) makespan = std::max(makespan, p.completionTime);
+        for (Algorithm algorithm : {Algorithm::CFS, Algorithm::EEVDF, Algorithm::Stride}) {
+            SchedulerParams params;
+            params.cfsMinGranularity = quantum;
+            params.eevdfSlice = quantum;
+            params.strideQuantum = quantum;
+            int last = 0;
+            bool valid = true;
+            for (const Process& p : simulate(algorithm, processes, params).processes) {
+                last = std::max(last, p.completionTime);
+                valid = valid && p.remainingTime == 0 && p.completionTime >= p.arrivalTime + p.burstTime;
+            }
+            if (!valid || last != makespan) {
+                std::cout << "FAILED: " << algorithmName(algorithm) << " did not run the workload to completion in round " << r << "\n";
+                return 1;
+            }
+        }
+
+        // Streamed runs reuse table slots; for the queue-based policies the
+        // results must still be those of a whole-table run
+        for (Algorithm algorithm : {Algorithm::FCFS, Algorithm::RR, Algorithm::MLQ, Algorithm::MLFQ}) {
+            SchedulerParams params;
+            params.rrQuantum = quantum;
+            std::vector<Process> expected = simulate(algorithm, processes, params).processes;
+            struct ListSource {
+                const std::vector<Process>& list;
+                size_t position = 0;
+                bool next(Process& p) {
+                    if (position == list.size()) return false;
+                    p = list[position++];
+                    return true;
+                }
+            } source{expected};
+            std::vector<int> completion(n + 1, -1);
+            ProcessTable table;
+            simulateStream(algorithm, source, [&](const ProcessTable& t, int i) { completion[t.id[i]] = t.completion[i]; }, table, params);
+            for (const Process& p : expected) {
+                if (completion[p.id] != p.completionTime) {
+                    std::cout << "FAILED: streamed " << algorithmName(algorithm) << " differs from the whole-table run in round " << r << "\n";
+                    return 1;
+                }
+            }
+        }
+    }
+    // Finishing on time says nothing about weights: two processes that stay
+    // runnable must split the CPU in the ratio of their share weights until
+    // the heavier one is done
+    const int shareBurst = 40000;
+    for (Algorithm algorithm : {Algorithm::CFS, Algorithm::EEVDF, Algorithm::Stride}) {
+        for (auto [heavy, light] : {std::pair{1, 3}, std::pair{2, 3}, std::pair{1, 2}}) {
+            std::vector<Process> pair = {{1, 0, shareBurst, heavy, shareBurst}, {2, 0, shareBurst, light, shareBurst}};
+            int heavyDone = 0;
+            for (const Process& p : simulate(algorithm, pair).processes) {
+                if (p.id == 1) heavyDone = p.completionTime;
+            }
+            double ratio = static_cast<double>(shareBurst) / (heavyDone - shareBurst);
+            double expected = static_cast<double>(shareWeight(heavy)) / shareWeight(light);
+            if (!(std::abs(ratio / expected - 1) <= 0.02)) {
+                std::cout << "FAILED: " << algorithmName(algorithm) << " split the CPU " << ratio << ":1 between priorities "
+                          << heavy << " and " << light << ", expected " << expected << ":1\n";
+                return 1;
+            }
+        }
+    }
+
+    std::cout << "Event-driven results and context switches matched the tick-by-tick versions on " << rounds
+              << " random workloads\n";
+    return 0;
+}
+
+enum class BurstDistribution { Exponential, HeavyTailed, Bimodal };
+
+struct WorkloadConfig {
+    int processes = 1000;
+    double meanBurst = 10;
+    double load = 0.9; // offered CPU utilization, sets the arrival rate
+    BurstDistribution burst = BurstDistribution::Exponential;
+    double priorityMix[3] = {0.2, 0.3, 0.5}; // system, interactive, batch
+    unsigned seed = 1;
+};
+
+// Poisson arrivals and bursts of at least one tick from the chosen
+// distribution. Heavy-tailed bursts are Pareto (alpha 1.5) capped at
+// 1000x the mean; bimodal ones are 80% short jobs around a quarter of the
+// mean and 20% long jobs around four times it. Ids are 1..n by arrival.
+// Produced one at a time, so a streamed run never holds the workload.
+class WorkloadStream {
+private:
+    WorkloadConfig config;
+    std::mt19937_64 rng;
+    std::exponential_distribution<double> gap;
+    std::exponential_distribution<double> exponential;
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::discrete_distribution<int> priority;
+    double paretoMin;
+    double clock = 0;
+    int produced = 0;
+
+    static constexpr double alpha = 1.5;
+
+public:
+    explicit WorkloadStream(const WorkloadConfig& c)
+        : config(c), rng(c.seed), gap(c.load / c.meanBurst), exponential(1.0 / c.meanBurst),
+          priority(std::begin(c.priorityMix), std::end(c.priorityMix)), paretoMin(c.meanBurst * (alpha - 1) / alpha) {}
+
+    bool next(Process& p) {
+        if (produced == config.processes) return false;
+        clock += gap(rng);
+        double burst = 0;
+        switch (config.burst) {
+        case BurstDistribution::Exponential:
+            burst = exponential(rng);
+            break;
+        case BurstDistribution::HeavyTailed:
+            burst = std::min(paretoMin / std::pow(1.0 - unit(rng), 1.0 / alpha), 1000 * config.meanBurst);
+            break;
+        case BurstDistribution::Bimodal:
+            burst = (unit(rng) < 0.8 ? config.meanBurst / 4 : config.meanBurst * 4) * (0.5 + unit(rng));
+            break;
+        }
+        p = Process{++produced, static_cast<int>(clock), std::max(1, static_cast<int>(std::lround(burst))), priority(rng) + 1, 0};
+        p.remainingTime = p.burstTime;
+        return true;
+    }
+};
+
+std::vector<Process> generateWorkload(const WorkloadConfig& config) {
+    std::vector<Process> processes;
+    processes.reserve(config.processes);
+    WorkloadStream stream(config);
+    Process p;
+    while (stream.next(p)) processes.push_back(p);
+    return processes;
+}
+
+// Every algorithm on generated workloads of 1K up to maxProcesses, by
+// factors of ten, each run in place on the same process table. Memory is
+// the peak heap use above what was live before the run, i.e. the
+// algorithm's own queues.
+int benchmarkSchedulers(int maxProcesses, const std::string& distribution) {
+    const std::vector<std::pair<std::string, BurstDistribution>> distributions = {
+        {"exponential", BurstDistribution::Exponential},
+        {"heavy-tailed", BurstDistribution::HeavyTailed},
+        {"bimodal", BurstDistribution::Bimodal},
+    };
+
+    bool any = false;
+    for (const auto& [distName, dist] : distributions) {
+        if (!distribution.empty() && distribution != distName) continue;
+        any = true;
+        std::cout << "\n--- " << distName << " bursts, load 0.9 ---\n";
+        std::cout << std::setw(10) << "Processes" << std::setw(10) << "Algorithm" << std::setw(12) << "Time (ms)"
+                  << std::setw(12) << "Memory (MB)" << std::setw(14) << "Processes/s" << std::setw(12) << "P99 wait" << "\n";
+        for (long n = 1000; n <= maxProcesses; n *= 10) {
+            WorkloadConfig config;
+            config.processes = static_cast<int>(n);
+            config.burst = dist;
+            ProcessTable table = ProcessTable::fromProcesses(generateWorkload(config));
+            for (Algorithm algorithm : allAlgorithms) {
+                table.reset();
+                long long before = heapBytes;
+                heapPeak = before;
+                auto start = std::chrono::steady_clock::now();
+                simulateTable(algorithm, table);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                double memoryMB = (heapPeak - before) / (1024.0 * 1024.0);
+                TableMetrics metrics = computeMetrics(table);
+                std::cout << std::setw(10) << n << std::setw(10) << algorithmName(algorithm) << std::fixed << std::setprecision(1)
+                          << std::setw(12) << elapsed.count() * 1000 << std::setw(12) << memoryMB << std::setw(14)
+                          << std::setprecision(0) << n / elapsed.count() << std::setw(12) << metrics.waiting.percentile(0.99) << "\n";
+                std::cout.unsetf(std::ios::fixed);
+                std::cout << std::setprecision(6);
+            }
+        }
+    }
+    if (!any) {
+        std::cerr << "Error: unknown burst distribution " << distribution << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Runs a batch of independent tasks on a fixed set of threads. Tasks are
+// dealt out in contiguous blocks, one deque per worker; a worker takes its
+// own tasks from the back and, once out, steals from the front of the
+// others', so uneven task costs still keep every thread busy.
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<WorkerQueue> queues;
+
+    bool takeOwn(size_t w, std::function<void()>& task) {
+        std::lock_guard<std::mutex> guard(queues[w].lock);
+        if (queues[w].tasks.empty()) return false;
+        task = std::move(queues[w].tasks.back());
+        queues[w].tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t w, std::function<void()>& task) {
+        for (size_t k = 1; k < queues.size(); ++k) {
+            WorkerQueue& victim = queues[(w + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.tasks.empty()) continue;
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+public:
+    explicit WorkStealingPool(unsigned threads) : queues(std::max(1u, threads)) {}
+
+    size_t size() const {
+        return queues.size();
+    }
+
+    // Runs every task and returns once all of them have finished. Tasks do
+    // not add more work, so a worker that finds nothing anywhere is done.
+    void run(std::vector<std::function<void()>> tasks) {
+        size_t workers = queues.size();
+        for (size_t w = 0; w < workers; ++w) {
+            size_t begin = tasks.size() * w / workers;
+            size_t end = tasks.size() * (w + 1) / workers;
+            for (size_t i = begin; i < end; ++i) {
+                queues[w].tasks.push_back(std::move(tasks[i]));
+            }
+        }
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([this, w] {
+                std::function<void()> task;
+                while (takeOwn(w, task) || steal(w, task)) {
+                    task();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+};
+
+bool hasFlag(int argc, char* argv[], const std::string& flag) {
+    for (int i = 2; i < argc; i++) {
+        if (flag == argv[i]) return true;
+    }
+    return false;
+}
+
+// Value of a --name=value option, or fallback
+std::string optionValue(int argc, char* argv[], const std::string& name, const std::string& fallback) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind(name + "=", 0) == 0) return arg.substr(name.size() + 1);
+    }
+    return fallback;
+}
+
+// Parses "a,b,c" or an inclusive range "start:end[:step]"
+std::vector<int> parseRange(const std::string& spec) {
+    std::vector<int> values;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+        size_t second = spec.find(':', colon + 1);
+        int start = std::stoi(spec.substr(0, colon));
+        int end = std::stoi(spec.substr(colon + 1, second == std::string::npos ? std::string::npos : second - colon - 1));
+        int step = second == std::string::npos ? 1 : std::stoi(spec.substr(second + 1));
+        for (int v = start; step > 0 && v <= end; v += step) values.push_back(v);
+    } else {
+        std::stringstream list(spec);
+        std::string item;
+        while (std::getline(list, item, ',')) values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+// Value at quantile q of values (reorders them)
+double percentile(std::vector<int>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+struct SweepPoint {
+    Algorithm algorithm;
+    SchedulerParams params;
+    std::string label;
+    size_t workload;
+
+    double avgWait = 0;
+    double p99Wait = 0;
+    double avgTurnaround = 0;
+    double p99Turnaround = 0;
+    long long contextSwitches = 0;
+};
+
+// Simulates every (policy x parameters x workload) combination on a
+// work-stealing pool and prints one row per combination
+int runSweep(int argc, char* argv[]) {
+    int processes = std::stoi(optionValue(argc, argv, "--processes", "20000"));
+    int seeds = std::stoi(optionValue(argc, argv, "--seeds", "1"));
+    unsigned threads = std::stoul(optionValue(argc, argv, "--threads", std::to_string(std::max(1u, std::thread::hardware_concurrency()))));
+    std::string policies = "," + optionValue(argc, argv, "--policies", "FCFS,SRTF,RR,MLQ,MLFQ,CFS,EEVDF,Stride") + ",";
+    // Every swept parameter is a length of time the policies divide by
+    bool valid = true;
+    auto ticks = [&](const char* option, const char* fallback) {
+        std::vector<int> values = parseRange(optionValue(argc, argv, option, fallback));
+        for (int v : values) {
+            if (v < 1 && valid) {
+                std::cerr << "Error: " << option << " values must be at least 1, got " << v << "\n";
+                valid = false;
+            }
+        }
+        return values;
+    };
+    std::vector<int> rrQuanta = ticks("--rr", "2,4,8,16");
+    std::vector<int> systemQuanta = ticks("--mlq-system", "2,4,8");
+    std::vector<int> interactiveQuanta = ticks("--mlq-interactive", "4,8,16");
+    std::vector<int> topQuanta = ticks("--mlfq-top", "4,8,16");
+    std::vector<int> middleQuanta = ticks("--mlfq-middle", "8,16,32");
+    std::vector<int> agingPeriods = ticks("--aging", "25,50,100,200");
+    std::vector<int> cfsLatencies = ticks("--cfs-latency", "12,24,48");
+    std::vector<int> eevdfSlices = ticks("--eevdf-slice", "2,4,8");
+    std::vector<int> strideQuanta = ticks("--stride", "2,4,8");
+    if (processes < 1 && valid) {
+        std::cerr << "Error: --processes must be at least 1, got " << processes << "\n";
+        valid = false;
+    }
+    if (!valid) return 1;
+    std::string csvPath = optionValue(argc, argv, "--csv", "");
+
+    // Workloads: every requested burst distribution with every seed
+    std::vector<std::string> workloadNames;
+    std::vector<std::vector<Process>> workloads;
+    std::stringstream distributions(optionValue(argc, argv, "--workloads", "exponential,heavy-tailed,bimodal"));
+    std::string name;
+    while (std::getline(distributions, name, ',')) {
+        WorkloadConfig config;
+        config.processes = processes;
+        if (name == "exponential") {
+            config.burst = BurstDistribution::Exponential;
+        } else if (name == "heavy-tailed") {
+            config.burst = BurstDistribution::HeavyTailed;
+        } else if (name == "bimodal") {
+            config.burst = BurstDistribution::Bimodal;
+        } else {
+            std::cerr << "Error: unknown burst distribution " << name << "\n";
+            return 1;
+        }
+        for (int seed = 1; seed <= seeds; ++seed) {
+            config.seed = seed;
+            workloadNames.push_back(seeds > 1 ? name + "/" + std::to_string(seed) : name);
+            workloads.push_back(generateWorkload(config));
+        }
+    }
+
+    std::vector<SweepPoint> grid;
+    auto wanted = [&](const char* policy) { return policies.find(std::string(",") + policy + ",") != std::string::npos; };
+    auto add = [&](Algorithm algorithm, const SchedulerParams& params, const std::string& label) {
+        for (size_t w = 0; w < workloads.size(); ++w) {
+            grid.push_back({algorithm, params, label, w});
+        }
+    };
+    SchedulerParams params;
+    if (wanted("FCFS")) add(Algorithm::FCFS, params, "-");
+    if (wanted("SRTF")) add(Algorithm::SRTF, params, "-");
+    for (int q : wanted("RR") ? rrQuanta : std::vector<int>()) {
+        params = SchedulerParams();
+        params.rrQuantum = q;
+        add(Algorithm::RR, params, "q=" + std::to_string(q));
+    }
+    for (int system : wanted("MLQ") ? systemQuanta : std::vector<int>()) {
+        for (int interactive : interactiveQuanta) {
+            params = SchedulerParams();
+            params.mlqQuanta[0] = system;
+            params.mlqQuanta[1] = interactive;
+            add(Algorithm::MLQ, params, "q=" + std::to_string(system) + "/" + std::to_string(interactive));
+        }
+    }
+    for (int top : wanted("MLFQ") ? topQuanta : std::vector<int>()) {
+        for (int middle : middleQuanta) {
+            for (int aging : agingPeriods) {
+                params = SchedulerParams();
+                params.mlfqQuanta[0] = top;
+                params.mlfqQuanta[1] = middle;
+                params.agingPeriod = aging;
+                add(Algorithm::MLFQ, params, "q=" + std::to_string(top) + "/" + std::to_string(middle) + " age=" + std::to_string(aging));
+            }
+        }
+    }
+    for (int latency : wanted("CFS") ? cfsLatencies : std::vector<int>()) {
+        params = SchedulerParams();
+        params.cfsLatency = latency;
+        add(Algorithm::CFS, params, "lat=" + std::to_string(latency));
+    }
+    for (int slice : wanted("EEVDF") ? eevdfSlices : std::vector<int>()) {
+        params = SchedulerParams();
+        params.eevdfSlice = slice;
+        add(Algorithm::EEVDF, params, "slice=" + std::to_string(slice));
+    }
+    for (int q : wanted("Stride") ? strideQuanta : std::vector<int>()) {
+        params = SchedulerParams();
+        params.strideQuantum = q;
+        add(Algorithm::Stride, params, "q=" + std::to_string(q));
+    }
+
+    WorkStealingPool pool(threads);
+    std::vector<std::function<void()>> tasks;
+    for (SweepPoint& point : grid) {
+        tasks.push_back([&point, &workloads] {
+            SimulationResult result = simulate(point.algorithm, workloads[point.workload], point.params);
+            std::vector<int> waits, turnarounds;
+            for (const Process& p : result.processes) {
+                waits.push_back(p.waitingTime);
+                turnarounds.push_back(p.turnaroundTime);
+            }
+            point.avgWait = std::accumulate(waits.begin(), waits.end(), 0.0) / waits.size();
+            point.avgTurnaround = std::accumulate(turnarounds.begin(), turnarounds.end(), 0.0) / turnarounds.size();
+            point.p99Wait = percentile(waits, 0.99);
+            point.p99Turnaround = percentile(turnarounds, 0.99);
+            point.contextSwitches = result.contextSwitches;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    pool.run(std::move(tasks));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::left << std::setw(7) << "Policy" << std::setw(20) << "Parameters" << std::setw(16) << "Workload"
+              << std::right << std::setw(12) << "Avg wait" << std::setw(12) << "P99 wait" << std::setw(12) << "Avg TAT"
+              << std::setw(12) << "P99 TAT" << std::setw(12) << "Switches" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (const SweepPoint& point : grid) {
+        std::cout << std::left << std::setw(7) << algorithmName(point.algorithm) << std::setw(20) << point.label
+                  << std::setw(16) << workloadNames[point.workload] << std::right << std::setw(12) << point.avgWait
+                  << std::setw(12) << point.p99Wait << std::setw(12) << point.avgTurnaround << std::setw(12)
+                  << point.p99Turnaround << std::setw(12) << point.contextSwitches << "\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(3) << grid.size() << " simulations of " << processes << " processes on " << pool.size()
+              << " threads in " << elapsed.count() << " s\n";
+
+    if (!csvPath.empty()) {
+        std::ofstream csv(csvPath);
+        if (!csv) {
+            std::cerr << "Error: cannot write " << csvPath << "\n";
+            return 1;
+        }
+        csv << "policy,parameters,workload,avg_wait,p99_wait,avg_turnaround,p99_turnaround,context_switches\n";
+        for (const SweepPoint& point : grid) {
+            csv << algorithmName(point.algorithm) << "," << point.label << "," << workloadNames[point.workload]
+                << "," << point.avgWait << "," << point.p99Wait << "," << point.avgTurnaround << "," << point.p99Turnaround
+                << "," << point.contextSwitches << "\n";
+        }
+    }
+    return 0;
+}
+
+struct SMPConfig {
+    int cpus = 4;
+    Algorithm algorithm = Algorithm::RR;
+    SchedulerParams params;
+    bool globalQueue = false; // one shared queue instead of one per CPU
+    bool stealing = true;     // idle CPUs pull work from the busiest queue
+    int migrationCost = 2;    // extra ticks when a process resumes on another CPU
+    double pinned = 0;        // fraction of processes pinned to CPU id % cpus
+};
+
+struct CPUStats {
+    long long busy = 0; // includes migration overhead
+    long long dispatches = 0;
+    long long contextSwitches = 0;
+    long long migrationsIn = 0;
+    long long steals = 0;
+};
+
+struct SMPResult {
+    std::vector<Process> processes;
+    std::vector<CPUStats> cpus;
+    int makespan = 0;
+};
+
+// Ready set of one CPU, or the shared one, under one of the existing
+// policies. Levels are FIFO; SRTF keeps (remaining, position) pairs so the
+// shortest job is taken first and the longest is the one given away.
+class RunQueue {
+private:
+    Algorithm algorithm;
+    const std::vector<Process>& processes;
+    const std::vector<int>& mlfqLevel;
+    std::deque<int> levels[3];
+    std::set<std::pair<int, int>> byRemaining;
+
+public:
+    RunQueue(Algorithm a, const std::vector<Process>& p, const std::vector<int>& level)
+        : algorithm(a), processes(p), mlfqLevel(level) {}
+
+    int levelOf(int i) const {
+        if (algorithm == Algorithm::MLQ) {
+            int priority = processes[i].priority;
+            return priority == 1 ? 0 : priority == 2 ? 1 : 2;
+        }
+        return algorithm == Algorithm::MLFQ ? mlfqLevel[i] : 0;
+    }
+
+    size_t size() const {
+        return levels[0].size() + levels[1].size() + levels[2].size() + byRemaining.size();
+    }
+
+    // A process preempted mid-quantum goes back to the front of its level
+    void push(int i, bool front = false) {
+        if (algorithm == Algorithm::SRTF) {
+            byRemaining.emplace(processes[i].remainingTime, i);
+        } else if (front) {
+            levels[levelOf(i)].push_front(i);
+        } else {
+            levels[levelOf(i)].push_back(i);
+        }
+    }
+
+    // Most urgent process, or -1
+    int pop() {
+        if (algorithm == Algorithm::SRTF) {
+            if (byRemaining.empty()) return -1;
+            int i = byRemaining.begin()->second;
+            byRemaining.erase(byRemaining.begin());
+            return i;
+        }
+        for (auto& level : levels) {
+            if (level.empty()) continue;
+            int i = level.front();
+            level.pop_front();
+            return i;
+        }
+        return -1;
+    }
+
+    // Least urgent process that may move to another CPU, or -1
+    template <typename Movable>
+    int steal(Movable movable) {
+        if (algorithm == Algorithm::SRTF) {
+            for (auto it = byRemaining.rbegin(); it != byRemaining.rend(); ++it) {
+                if (!movable(it->second)) continue;
+                int i = it->second;
+                byRemaining.erase(std::next(it).base());
+                return i;
+            }
+            return -1;
+        }
+        for (int l = 2; l >= 0; --l) {
+            for (auto it = levels[l].rbegin(); it != levels[l].rend(); ++it) {
+                if (!movable(*it)) continue;
+                int i = *it;
+                levels[l].erase(std::next(it).base());
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Lower is more urgent; only SRTF, MLQ and MLFQ preempt. SRTF keys are
+    // (remaining, position), the ready set's order.
+    long long urgency(int i, int remainingNow) const {
+        switch (algorithm) {
+        case Algorithm::SRTF: return static_cast<long long>(remainingNow) << 32 | i;
+        case Algorithm::MLQ:
+        case Algorithm::MLFQ: return levelOf(i);
+        default: return 0;
+        }
+    }
+
+    // MLFQ aging: every queued process back to the top level, lower levels
+    // in order behind the top one
+    void boost(std::vector<int>& level, std::vector<int>& used) {
+        for (int l = 1; l < 3; ++l) {
+            for (int i : levels[l]) {
+                levels[0].push_back(i);
+                level[i] = 0;
+                used[i] = 0;
+            }
+            levels[l].clear();
+        }
+    }
+};
+
+// Event-driven simulation of several CPUs. In per-core mode each arrival
+// goes to the least loaded CPU (or its own CPU if pinned), a preempted or
+// expired process stays on the CPU it ran on, and an idle CPU with an
+// empty queue steals the least urgent movable process from the longest
+// queue. In global mode unpinned processes share one queue; pinned ones
+// wait on their CPU's own queue, which that CPU serves first. Slices are
+// whole quanta (or the rest of the burst); a more urgent arrival preempts
+// the least urgent running process. MLFQ slices are one tick, as in the
+// single-CPU policy, demoting after a full quantum and boosting every
+// queued process to the top each aging period.
+//
+// Events at the same time follow the single-CPU engine, so one CPU gives
+// simulateTable's results ("scheduler verify" checks): arrivals before
+// slice ends, except under MLFQ, whose expired process is requeued first;
+// then aging, and only then do idle CPUs pick their next process. An MLQ
+// process preempted as its quantum ran out is rotated the next time its
+// level is served, as the tick loop did.
+SMPResult simulateSMP(std::vector<Process> processes, const SMPConfig& config) {
+    const int n = processes.size();
+    const int cpus = config.cpus;
+    const Algorithm algorithm = config.algorithm;
+    const SchedulerParams& params = config.params;
+
+    std::vector<int> level(n, 0), used(n, 0), lastCpu(n, -1), home(n, -1);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int i = 0; i < n; ++i) {
+        if (unit(rng) < config.pinned) home[i] = processes[i].id % cpus;
+    }
+
+    std::vector<RunQueue> queues;
+    for (int c = 0; c <= cpus; ++c) queues.emplace_back(algorithm, processes, level);
+    RunQueue& shared = queues[cpus];
+
+    struct CPU {
+        int running = -1;
+        int last = -1;
+        int start = 0;
+        int overhead = 0; // migration ticks at the start of this slice
+        int generation = 0;
+    };
+    std::vector<CPU> cpu(cpus);
+    std::vector<CPUStats> stats(cpus);
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return processes[a].arrivalTime < processes[b].arrivalTime;
+    });
+
+    // Slice ends as (time, cpu, generation); a preempted slice's event is
+    // recognized as stale by its generation
+    std::priority_queue<std::tuple<int, int, int>, std::vector<std::tuple<int, int, int>>, std::greater<std::tuple<int, int, int>>> sliceEnds;
+
+    auto sliceFor = [&](int i) {
+        int remaining = processes[i].remainingTime;
+        switch (algorithm) {
+        case Algorithm::RR: return std::min(params.rrQuantum, remaining);
+        case Algorithm::MLFQ: return 1;
+        case Algorithm::MLQ: {
+            int l = queues[0].levelOf(i);
+            if (l == 2) return remaining;
+            return std::min(params.mlqQuanta[l] - used[i], remaining);
+        }
+        default: return remaining;
+        }
+    };
+    auto quantumOf = [&](int i) {
+        int l = queues[0].levelOf(i);
+        if (l == 2) return INT_MAX;
+        if (algorithm == Algorithm::MLQ) return params.mlqQuanta[l];
+        if (algorithm == Algorithm::MLFQ) return params.mlfqQuanta[l];
+        return algorithm == Algorithm::RR ? params.rrQuantum : INT_MAX;
+    };
+
+    int completed = 0;
+    int now = 0;
+    // A process resuming on another CPU first spends migrationCost ticks
+    // there without progress. Charged to the slice rather than the burst, so
+    // that every slice still makes progress however often a process moves.
+    auto start = [&](int c, int i) {
+        CPU& core = cpu[c];
+        core.overhead = 0;
+        if (lastCpu[i] != -1 && lastCpu[i] != c) {
+            core.overhead = config.migrationCost;
+            stats[c].migrationsIn++;
+        }
+        lastCpu[i] = c;
+        // A stolen MLQ process may still carry an expired quantum
+        if (used[i] >= quantumOf(i)) used[i] = 0;
+        if (core.last != -1 && core.last != i) stats[c].contextSwitches++;
+        stats[c].dispatches++;
+        core.running = core.last = i;
+        core.start = now;
+        core.generation++;
+        sliceEnds.emplace(now + core.overhead + sliceFor(i), c, core.generation);
+    };
+    // Ticks of real work c's current slice has done so far
+    auto progress = [&](int c) { return std::max(0, now - cpu[c].start - cpu[c].overhead); };
+    // Stops whatever c is running and charges the time it ran
+    auto stop = [&](int c) {
+        CPU& core = cpu[c];
+        int i = core.running;
+        int ran = progress(c);
+        processes[i].remainingTime -= ran;
+        used[i] += ran;
+        stats[c].busy += now - core.start;
+        core.running = -1;
+        core.generation++;
+        return i;
+    };
+    auto queueFor = [&](int i, int c) -> RunQueue& {
+        return config.globalQueue && home[i] == -1 ? shared : queues[c];
+    };
+    auto finish = [&](int i) {
+        Process& p = processes[i];
+        p.completionTime = now;
+        p.turnaroundTime = p.completionTime - p.arrivalTime;
+        p.waitingTime = p.turnaroundTime - p.burstTime;
+        completed++;
+    };
+    // Most urgent process waiting for c, rotating MLQ processes whose
+    // quantum ran out while they were preempted
+    auto take = [&](int c) {
+        RunQueue& q = queues[c].size() > 0 || !config.globalQueue ? queues[c] : shared;
+        int i = q.pop();
+        while (i != -1 && algorithm == Algorithm::MLQ && used[i] >= quantumOf(i)) {
+            used[i] = 0;
+            q.push(i);
+            i = q.pop();
+        }
+        return i;
+    };
+    auto dispatch = [&](int c) {
+        int i = take(c);
+        if (i == -1 && !config.globalQueue && config.stealing) {
+            int victim = -1;
+            for (int v = 0; v < cpus; ++v) {
+                if (v != c && queues[v].size() > 0 && (victim == -1 || queues[v].size() > queues[victim].size())) victim = v;
+            }
+            if (victim != -1) {
+                i = queues[victim].steal([&](int p) { return home[p] == -1; });
+                if (i != -1) stats[c].steals++;
+            }
+        }
+        if (i != -1) start(c, i);
+    };
+    auto leastLoaded = [&]() {
+        int best = 0;
+        for (int k = 1; k < cpus; ++k) {
+            if (queues[k].size() + (cpu[k].running != -1) < queues[best].size() + (cpu[best].running != -1)) best = k;
+        }
+        return best;
+    };
+    // Pinned processes go to their CPU, others to the least loaded CPU or,
+    // with a shared queue, to whichever CPU is idle or preemptible
+    auto admit = [&](int i) {
+        int first = 0;
+        int last = cpus;
+        if (home[i] != -1 || !config.globalQueue) {
+            first = home[i] != -1 ? home[i] : leastLoaded();
+            last = first + 1;
+        }
+        int target = -1;
+        long long worst = LLONG_MIN;
+        for (int k = first; k < last; ++k) {
+            if (cpu[k].running == -1) {
+                queueFor(i, k).push(i);
+                return;
+            }
+            int r = cpu[k].running;
+            long long key = shared.urgency(r, processes[r].remainingTime - progress(k));
+            if (key > worst) {
+                worst = key;
+                target = k;
+            }
+        }
+        if (shared.urgency(i, processes[i].remainingTime) < worst) {
+            // The preempted process may be due to finish right now, its
+            // slice end not yet handled
+            int preempted = stop(target);
+            if (processes[preempted].remainingTime == 0) {
+                finish(preempted);
+            } else {
+                queueFor(preempted, target).push(preempted, true);
+            }
+            start(target, i);
+            return;
+        }
+        queueFor(i, first).push(i);
+    };
+
+    int next = 0;
+    auto nextArrival = [&]() { return next < n ? processes[order[next]].arrivalTime : INT_MAX; };
+    auto nextSliceEnd = [&]() {
+        while (!sliceEnds.empty()) {
+            auto [t, c, generation] = sliceEnds.top();
+            if (generation == cpu[c].generation) return t;
+            sliceEnds.pop();
+        }
+        return INT_MAX;
+    };
+    const bool sliceEndsFirst = algorithm == Algorithm::MLFQ;
+    while (completed < n) {
+        int arrival = nextArrival();
+        int sliceEnd = nextSliceEnd();
+        if (std::min(arrival, sliceEnd) == INT_MAX) break;
+
+        if (sliceEndsFirst ? arrival < sliceEnd : arrival <= sliceEnd) {
+            now = arrival;
+            admit(order[next++]);
+        } else {
+            int c = std::get<1>(sliceEnds.top());
+            sliceEnds.pop();
+            now = sliceEnd;
+            int i = stop(c);
+            if (processes[i].remainingTime == 0) {
+                finish(i);
+            } else {
+                if (used[i] >= quantumOf(i)) {
+                    used[i] = 0;
+                    if (algorithm == Algorithm::MLFQ && level[i] < 2) level[i]++;
+                }
+                queueFor(i, c).push(i);
+            }
+        }
+
+        // Once every event at this time is in, MLFQ ages and idle CPUs pick
+        // up anything left waiting or worth stealing. MLFQ slices are one
+        // tick, so anyone queued at an aging point means an event there.
+        if (std::min(nextArrival(), nextSliceEnd()) > now) {
+            if (algorithm == Algorithm::MLFQ && now > 0 && now % params.agingPeriod == 0) {
+                for (auto& q : queues) q.boost(level, used);
+            }
+            for (int c = 0; c < cpus; ++c) {
+                if (cpu[c].running == -1) dispatch(c);
+            }
+        }
+    }
+
+    SMPResult result{std::move(processes), std::move(stats), now};
+    return result;
+}
+
+// With one CPU the multi-CPU simulation must give exactly the single-CPU
+// engine's results, for every policy it supports
+int verifySingleCPU(int rounds) {
+    std::mt19937 rng(11);
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<Process> processes = randomWorkload(rng, r % 2);
+        SMPConfig config;
+        config.cpus = 1;
+        config.params.rrQuantum = 1 + rng() % 6;
+        for (Algorithm algorithm : {Algorithm::FCFS, Algorithm::SRTF, Algorithm::RR, Algorithm::MLQ, Algorithm::MLFQ}) {
+            config.algorithm = algorithm;
+            // Same order as simulate() used, so that ties break alike
+            std::vector<Process> expected = simulate(algorithm, processes, config.params).processes;
+            std::vector<Process> input = expected;
+            for (Process& p : input) p.remainingTime = p.burstTime;
+            if (!sameResults(expected, simulateSMP(input, config).processes)) {
+                std::cout << "FAILED: " << algorithmName(algorithm)
+                          << " on one CPU differs from the single-CPU engine in round " << r << "\n";
+                return 1;
+            }
+        }
+    }
+    std::cout << "One-CPU multi-CPU simulation matched the single-CPU engine on " << rounds << " random workloads\n";
+    return 0;
+}
+
+void printSMPSummary(const SMPResult& result) {
+    std::vector<int> waits;
+    double turnaround = 0;
+    for (const Process& p : result.processes) {
+        waits.push_back(p.waitingTime);
+        turnaround += p.turnaroundTime;
+    }
+    double wait = std::accumulate(waits.begin(), waits.end(), 0.0) / waits.size();
+    long long busiest = 0, switches = 0, migrations = 0, steals = 0;
+    double totalBusy = 0;
+    for (const CPUStats& s : result.cpus) {
+        busiest = std::max(busiest, s.busy);
+        totalBusy += s.busy;
+        switches += s.contextSwitches;
+        migrations += s.migrationsIn;
+        steals += s.steals;
+    }
+    double meanBusy = totalBusy / result.cpus.size();
+    std::cout << "Average Turnaround Time: " << turnaround / result.processes.size() << "\n";
+    std::cout << "Average Waiting Time: " << wait << "\n";
+    std::cout << "P99 Waiting Time: " << percentile(waits, 0.99) << "\n";
+    std::cout << "Makespan: " << result.makespan << ", context switches: " << switches << ", migrations: " << migrations
+              << ", steals: " << steals << "\n";
+    std::cout << "Mean utilization: " << meanBusy / std::max(1, result.makespan)
+              << ", load imbalance (busiest / mean - 1): " << (meanBusy > 0 ? busiest / meanBusy - 1 : 0) << "\n";
+}
+
+// Multi-CPU run of one generated workload; --compare runs the same
+// workload with a global queue, per-core queues and per-core with stealing
+int runSMP(int argc, char* argv[]) {
+    SMPConfig config;
+    config.cpus = std::stoi(optionValue(argc, argv, "--cpus", "8"));
+    if (config.cpus < 1) {
+        std::cerr << "Error: --cpus must be at least 1\n";
+        return 1;
+    }
+    std::string policy = optionValue(argc, argv, "--policy", "RR");
+    if (!parseAlgorithm(policy, config.algorithm)) {
+        std::cerr << "Error: unknown policy " << policy << "\n";
+        return 1;
+    }
+    if (config.algorithm > Algorithm::MLFQ) {
+        std::cerr << "Error: the multi-CPU simulation does not support " << policy << "\n";
+        return 1;
+    }
+    config.params.rrQuantum = std::stoi(optionValue(argc, argv, "--quantum", "4"));
+    if (config.params.rrQuantum < 1) {
+        std::cerr << "Error: --quantum must be at least 1\n";
+        return 1;
+    }
+    config.globalQueue = optionValue(argc, argv, "--queue", "per-core") == "global";
+    config.stealing = !hasFlag(argc, argv, "--no-steal");
+    config.migrationCost = std::stoi(optionValue(argc, argv, "--migration-cost", "2"));
+    config.pinned = std::stod(optionValue(argc, argv, "--pinned", "0"));
+
+    WorkloadConfig workload;
+    workload.processes = std::stoi(optionValue(argc, argv, "--processes", "100000"));
+    workload.load = std::stod(optionValue(argc, argv, "--load", "0.9")) * config.cpus;
+    std::string distribution = optionValue(argc, argv, "--workload", "exponential");
+    if (distribution == "heavy-tailed") {
+        workload.burst = BurstDistribution::HeavyTailed;
+    } else if (distribution == "bimodal") {
+        workload.burst = BurstDistribution::Bimodal;
+    } else if (distribution != "exponential") {
+        std::cerr << "Error: unknown burst distribution " << distribution << "\n";
+        return 1;
+    }
+    std::vector<Process> processes = generateWorkload(workload);
+
+    std::vector<SMPConfig> runs = {config};
+    if (hasFlag(argc, argv, "--compare")) {
+        runs.assign(3, config);
+        runs[0].globalQueue = true;
+        runs[1].globalQueue = false;
+        runs[1].stealing = false;
+        runs[2].globalQueue = false;
+        runs[2].stealing = true;
+    }
+    for (const SMPConfig& run : runs) {
+        auto start = std::chrono::steady_clock::now();
+        SMPResult result = simulateSMP(processes, run);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "\n--- " << algorithmName(run.algorithm) << " on " << run.cpus << " CPUs, "
+                  << (run.globalQueue ? "global queue" : run.stealing ? "per-core queues with stealing" : "per-core queues")
+                  << ", migration cost " << run.migrationCost << ", " << run.pinned * 100 << "% pinned ---\n";
+        printSMPSummary(result);
+        if (runs.size() == 1) {
+            std::cout << std::setw(5) << "CPU" << std::setw(14) << "Busy" << std::setw(13) << "Utilization" << std::setw(12)
+                      << "Dispatches" << std::setw(12) << "Switches" << std::setw(12) << "Migrations" << std::setw(10)
+                      << "Steals" << "\n";
+            for (size_t c = 0; c < result.cpus.size(); ++c) {
+                const CPUStats& s = result.cpus[c];
+                std::cout << std::setw(5) << c << std::setw(14) << s.busy << std::setw(13)
+                          << static_cast<double>(s.busy) / std::max(1, result.makespan) << std::setw(12) << s.dispatches
+                          << std::setw(12) << s.contextSwitches << std::setw(12) << s.migrationsIn << std::setw(10)
+                          << s.steals << "\n";
+            }
+        }
+        std::cout << "Simulated " << processes.size() << " processes in " << elapsed.count() << " ms\n";
+    }
+    return 0;
+}
+
+// Real work for the thread-pool executor. A task is resumable: each call
+// does up to budget units and returns how many are left, which lets the
+// executor preempt it at quantum boundaries the way a coroutine yielding
+// after every unit would.
+using RealTask = std::function<int(int budget)>;
+
+// Busy-loop iterations per microsecond on this machine
+double calibrateSpin() {
+    volatile unsigned sink = 0;
+    const long iterations = 1 << 22;
+    auto start = std::chrono::steady_clock::now();
+    for (long k = 0; k < iterations; ++k) sink = sink * 1664525u + 1013904223u;
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return iterations / std::max(1.0, elapsed.count());
+}
+
+RealTask makeSpinTask(int units, long iterationsPerUnit) {
+    return [left = units, iterationsPerUnit](int budget) mutable {
+        volatile unsigned sink = 0;
+        int run = std::min(left, budget);
+        for (long k = 0; k < run * iterationsPerUnit; ++k) sink = sink * 1664525u + 1013904223u;
+        left -= run;
+        return left;
+    };
+}
+
+// Ready sets for the executor, which calls them with its lock held:
+// admit a task with its length in units, pick the next one, tell it how
+// many units to run, and requeue it with what is left after a slice
+struct PoolRoundRobin {
+    int quantum;
+    std::deque<int> ready;
+
+    explicit PoolRoundRobin(int q) : quantum(q) {}
+
+    void admit(int i, int, int) { ready.push_back(i); }
+    bool empty() const { return ready.empty(); }
+    int pick(long long) {
+        int i = ready.front();
+        ready.pop_front();
+        return i;
+    }
+    int budget(int) const { return quantum; }
+    void requeue(int i, int, int) { ready.push_back(i); }
+};
+
+// Tasks cannot be interrupted mid-slice, so a newly arrived shorter task
+// waits for the next quantum boundary
+struct PoolSRTF {
+    int quantum;
+    std::set<std::pair<int, int>> ready; // (units left, task)
+
+    explicit PoolSRTF(int q) : quantum(q) {}
+
+    void admit(int i, int units, int) { ready.emplace(units, i); }
+    bool empty() const { return ready.empty(); }
+    int pick(long long) {
+        int i = ready.begin()->second;
+        ready.erase(ready.begin());
+        return i;
+    }
+    int budget(int) const { return quantum; }
+    void requeue(int i, int left, int) { ready.emplace(left, i); }
+};
+
+// Three levels with a quantum each at the top two; a task that uses its
+// whole quantum moves down, and every agingMicros everything below the top
+// moves back up
+struct PoolFeedbackQueue {
+    int quanta[2];
+    long long agingMicros;
+    long long nextBoost;
+    std::deque<int> levels[3];
+    std::vector<int> level;
+
+    PoolFeedbackQueue(int topQuantum, int middleQuantum, long long aging, size_t tasks)
+        : quanta{topQuantum, middleQuantum}, agingMicros(aging), nextBoost(aging), level(tasks, 0) {}
+
+    void admit(int i, int, int) { levels[0].push_back(i); }
+    bool empty() const { return levels[0].empty() && levels[1].empty() && levels[2].empty(); }
+    int pick(long long now) {
+        if (now >= nextBoost) {
+            for (int l = 1; l < 3; l++) {
+                for (int i : levels[l]) {
+                    levels[0].push_back(i);
+                    level[i] = 0;
+                }
+                levels[l].clear();
+            }
+            nextBoost = (now / agingMicros + 1) * agingMicros;
+        }
+        std::deque<int>& q = levels[!levels[0].empty() ? 0 : !levels[1].empty() ? 1 : 2];
+        int i = q.front();
+        q.pop_front();
+        return i;
+    }
+    int budget(int i) const { return level[i] < 2 ? quanta[level[i]] : INT_MAX; }
+    void requeue(int i, int, int ran) {
+        if (level[i] < 2 && ran >= quanta[level[i]]) level[i]++;
+        levels[level[i]].push_back(i);
+    }
+};
+
+struct RealRun {
+    ProcessTable table; // times in microseconds, burst = measured service time
+    long long slices = 0;
+    long long dispatches = 0; // slices started without waiting for work
+    double dispatchNanos = 0; // total pick-and-handoff time of those
+    double seconds = 0;
+};
+
+// Releases each process's task at its arrival (one unit = unitMicros) and
+// runs the ready set on a pool of threads under policy. A worker that
+// finishes a slice takes the lock, requeues or retires the task and picks
+// the next; the time from the end of one slice to the start of the next is
+// the dispatch overhead.
+template<typename Policy>
+RealRun runOnPool(const std::vector<Process>& processes, std::vector<RealTask>& tasks, Policy policy, int threads,
+                  int unitMicros) {
+    const int n = processes.size();
+    RealRun run;
+    run.table = ProcessTable::fromProcesses(processes);
+    std::vector<long long> submitted(n), finished(n), service(n, 0);
+    std::vector<int> left(n);
+    for (int i = 0; i < n; ++i) left[i] = processes[i].burstTime;
+
+    std::mutex lock;
+    std::condition_variable workAvailable;
+    int done = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto micros = [&start] {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto worker = [&] {
+        long long slices = 0, dispatches = 0;
+        double dispatchNanos = 0;
+        std::unique_lock<std::mutex> guard(lock);
+        auto sliceEnd = std::chrono::steady_clock::now();
+        while (true) {
+            bool waited = false;
+            while (policy.empty() && done < n) {
+                workAvailable.wait(guard);
+                waited = true;
+            }
+            if (done == n) break;
+            int i = policy.pick(micros());
+            int budget = policy.budget(i);
+            guard.unlock();
+
+            auto sliceStart = std::chrono::steady_clock::now();
+            if (!waited) {
+                dispatches++;
+                dispatchNanos += std::chrono::duration<double, std::nano>(sliceStart - sliceEnd).count();
+            }
+            int remaining = tasks[i](budget);
+            sliceEnd = std::chrono::steady_clock::now();
+            service[i] += std::chrono::duration_cast<std::chrono::microseconds>(sliceEnd - sliceStart).count();
+            slices++;
+
+            guard.lock();
+            if (remaining == 0) {
+                finished[i] = micros();
+                if (++done == n) workAvailable.notify_all();
+            } else {
+                policy.requeue(i, remaining, left[i] - remaining);
+                workAvailable.notify_one();
+            }
+            left[i] = remaining;
+        }
+        run.slices += slices;
+        run.dispatches += dispatches;
+        run.dispatchNanos += dispatchNanos;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (int i = 0; i < n; ++i) {
+        std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<long long>(processes[i].arrivalTime) * unitMicros));
+        std::lock_guard<std::mutex> guard(lock);
+        submitted[i] = micros();
+        policy.admit(i, processes[i].burstTime, processes[i].priority);
+        workAvailable.notify_one();
+    }
+    for (std::thread& t : pool) t.join();
+    run.seconds = micros() / 1e6;
+
+    for (int i = 0; i < n; ++i) {
+        run.table.arrival[i] = static_cast<int>(submitted[i]);
+        run.table.burst[i] = static_cast<int>(std::max(1LL, service[i]));
+        run.table.remaining[i] = 0;
+        run.table.completion[i] = static_cast<int>(finished[i]);
+    }
+    return run;
+}
+
+// Runs a generated workload as real spinning tasks on a thread pool, then
+// the same workload through the SMP simulation (a global queue, no
+// migration cost) on as many CPUs, both reported in microseconds
+int runReal(int argc, char* argv[]) {
+    int threads = std::stoi(optionValue(argc, argv, "--threads", std::to_string(std::max(1u, std::thread::hardware_concurrency()))));
+    int unitMicros = std::stoi(optionValue(argc, argv, "--unit-us", "50"));
+    if (threads < 1) {
+        std::cerr << "Error: --threads must be at least 1\n";
+        return 1;
+    }
+    if (unitMicros < 1) {
+        std::cerr << "Error: --unit-us must be at least 1\n";
+        return 1;
+    }
+    std::string policy = optionValue(argc, argv, "--policy", "RR");
+    bool perProcess = hasFlag(argc, argv, "--table");
+    WorkloadConfig workload;
+    workload.processes = std::stoi(optionValue(argc, argv, "--processes", "1000"));
+    workload.load = std::stod(optionValue(argc, argv, "--load", "0.9")) * threads;
+    std::vector<Process> processes = generateWorkload(workload);
+
+    SMPConfig config;
+    config.cpus = threads;
+    config.globalQueue = true;
+    config.migrationCost = 0;
+    if (!parseAlgorithm(policy, config.algorithm) ||
+        (config.algorithm != Algorithm::RR && config.algorithm != Algorithm::SRTF && config.algorithm != Algorithm::MLFQ)) {
+        std::cerr << "Error: the real executor supports RR, SRTF and MLFQ, not " << policy << "\n";
+        return 1;
+    }
+    const SchedulerParams& params = config.params;
+
+    double iterationsPerMicro = calibrateSpin();
+    std::vector<RealTask> tasks;
+    for (const Process& p : processes) {
+        tasks.push_back(makeSpinTask(p.burstTime, std::lround(iterationsPerMicro * unitMicros)));
+    }
+    RealRun real;
+    if (config.algorithm == Algorithm::RR) {
+        real = runOnPool(processes, tasks, PoolRoundRobin(params.rrQuantum), threads, unitMicros);
+    } else if (config.algorithm == Algorithm::SRTF) {
+        real = runOnPool(processes, tasks, PoolSRTF(params.rrQuantum), threads, unitMicros);
+    } else {
+        real = runOnPool(processes, tasks,
+                         PoolFeedbackQueue(params.mlfqQuanta[0], params.mlfqQuanta[1],
+                                           static_cast<long long>(params.agingPeriod) * unitMicros, processes.size()),
+                         threads, unitMicros);
+    }
+
+    SMPResult simulated = simulateSMP(processes, config);
+    ProcessTable expected = ProcessTable::fromProcesses(simulated.processes);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        expected.arrival[i] *= unitMicros;
+        expected.burst[i] *= unitMicros;
+        expected.completion[i] *= unitMicros;
+    }
+
+    std::string where = " on " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+    printResults(real.table, "Real " + policy + where + ", times in us", perProcess);
+    std::cout << "Throughput: " << processes.size() / real.seconds << " tasks/s, " << real.slices << " slices, dispatch overhead "
+              << real.dispatchNanos / std::max(1LL, real.dispatches) << " ns per slice\n";
+    printResults(expected, "Simulated " + policy + where + ", times in us", perProcess);
+    return 0;
+}
+
+// Times one generated workload with and without a trace attached, to show
+// what tracing costs, then prints the per-level counters and optionally
+// writes the retained events as Chrome trace JSON
+int runTrace(int argc, char* argv[]) {
+    if (!SCHEDULER_TRACE) {
+        std::cerr << "Error: tracing is compiled out; rebuild with -DSCHEDULER_TRACE=1\n";
+        return 1;
+    }
+    WorkloadConfig config;
+    config.processes = std::stoi(optionValue(argc, argv, "--processes", "200000"));
+    std::string policy = optionValue(argc, argv, "--policy", "MLFQ");
+    Algorithm algorithm;
+    if (!parseAlgorithm(policy, algorithm)) {
+        std::cerr << "Error: unknown policy " << policy << "\n";
+        return 1;
+    }
+    size_t capacity = std::stoull(optionValue(argc, argv, "--capacity", "1048576"));
+    std::string outPath = optionValue(argc, argv, "--out", "");
+
+    // Best of three runs each
+    ProcessTable table = ProcessTable::fromProcesses(generateWorkload(config));
+    double untraced = 1e9, traced = 1e9;
+    std::unique_ptr<TraceBuffer> trace;
+    for (int rep = 0; rep < 3; ++rep) {
+        table.reset();
+        auto start = std::chrono::steady_clock::now();
+        simulateTable(algorithm, table);
+        untraced = std::min(untraced, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        trace = std::make_unique<TraceBuffer>(capacity);
+        table.reset();
+        start = std::chrono::steady_clock::now();
+        simulateTable(algorithm, table, SchedulerParams(), trace.get());
+        traced = std::min(traced, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    unsigned long long events = trace->size() + trace->dropped();
+    std::cout << policy << " on " << config.processes << " processes: " << untraced * 1000 << " ms untraced, "
+              << traced * 1000 << " ms traced (+" << (traced / untraced - 1) * 100 << "%), " << events << " events, "
+              << (traced - untraced) * 1e9 / std::max(1ULL, events) << " ns per event\n";
+    std::cout << "Kept the last " << trace->size() << " events, overwrote " << trace->dropped() << "\n";
+    trace->printCounters();
+
+    if (!outPath.empty()) {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "Error: cannot write " << outPath << "\n";
+            return 1;
+        }
+        trace->writeChromeTrace(out, policy);
+        std::cout << "Wrote " << outPath << "\n";
+    }
+    return 0;
+}
+
+// One generated workload through the chosen algorithms, in place on a
+// process table, reported with tail percentiles
+int runWorkload(int argc, char* argv[]) {
+    WorkloadConfig config;
+    config.processes = std::stoi(optionValue(argc, argv, "--processes", "1000000"));
+    std::string distribution = optionValue(argc, argv, "--workload", "exponential");
+    if (distribution == "heavy-tailed") {
+        config.burst = BurstDistribution::HeavyTailed;
+    } else if (distribution == "bimodal") {
+        config.burst = BurstDistribution::Bimodal;
+    } else if (distribution != "exponential") {
+        std::cerr << "Error: unknown burst distribution " << distribution << "\n";
+        return 1;
+    }
+    std::vector<Algorithm> algorithms;
+    std::stringstream policies(optionValue(argc, argv, "--policies", "FCFS,SRTF,RR,MLQ,MLFQ,CFS,EEVDF,Stride"));
+    std::string name;
+    while (std::getline(policies, name, ',')) {
+        Algorithm algorithm;
+        if (!parseAlgorithm(name, algorithm)) {
+            std::cerr << "Error: unknown policy " << name << "\n";
+            return 1;
+        }
+        algorithms.push_back(algorithm);
+    }
+    bool perProcess = hasFlag(argc, argv, "--table");
+
+    ProcessTable table = ProcessTable::fromProcesses(generateWorkload(config));
+    for (Algorithm algorithm : algorithms) {
+        table.reset();
+        simulateTable(algorithm, table);
+        printResults(table, algorithmName(algorithm), perProcess);
+    }
+    return 0;
+}
+
+// Recorded workloads hold id, arrival, burst and priority per process and
+// must be sorted by arrival. CSV has one process per line, with an
+// optional header and '#' comments. The binary format is the magic
+// "SCHEDWL1" followed by one record per process of four LEB128 varints:
+// the id change (zigzag), the arrival gap, the burst and the priority
+// (zigzag), typically four or five bytes in all.
+const char binaryWorkloadMagic[8] = {'S', 'C', 'H', 'E', 'D', 'W', 'L', '1'};
+
+bool isBinaryWorkload(const std::string& path) {
+    char magic[sizeof(binaryWorkloadMagic)] = {};
+    std::ifstream in(path, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, binaryWorkloadMagic, sizeof(magic)) == 0;
+}
+
+// The simulation clock is an int and INT_MAX stands for "no more
+// arrivals", so a replayed workload must be done by INT_MAX - 1
+const long long maxReplayTime = INT_MAX - 1;
+
+// What the simulation cannot replay; empty if p is fine. horizon follows
+// when the CPU would be done with everything read so far: the FCFS
+// makespan, which every policy here reaches at the same time since none
+// idles with work waiting.
+std::string checkWorkloadRecord(const Process& p, int& lastArrival, long long& horizon) {
+    if (p.arrivalTime < 0 || p.burstTime < 1) return "arrival must be >= 0 and burst >= 1";
+    if (p.arrivalTime < lastArrival) return "not sorted by arrival";
+    lastArrival = p.arrivalTime;
+    horizon = std::max<long long>(horizon, p.arrivalTime) + p.burstTime;
+    if (horizon > maxReplayTime) return "workload runs past the simulation's last tick (" + std::to_string(maxReplayTime) + ")";
+    return "";
+}
+
+// Reads a CSV workload in 1 MB chunks
+class CSVWorkloadReader {
+private:
+    std::FILE* file;
+    std::vector<char> buffer = std::vector<char>(1 << 20);
+    size_t begin = 0, end = 0;
+    bool eof = false;
+    long long line = 0;
+    bool headerAllowed = true; // until the first line that is not blank or a comment
+    int lastArrival = 0;
+    long long horizon = 0;
+
+    // The next line without its terminator, or false at the end
+    bool nextLine(const char*& first, const char*& last) {
+        while (true) {
+            const char* start = buffer.data() + begin;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+            if (newline || (eof && begin < end)) {
+                first = start;
+                last = newline ? newline : buffer.data() + end;
+                begin = last - buffer.data() + (newline ? 1 : 0);
+                line++;
+                return true;
+            }
+            if (eof) return false;
+            if (begin == 0 && end == buffer.size()) buffer.resize(buffer.size() * 2);
+            std::memmove(buffer.data(), start, end - begin);
+            end -= begin;
+            begin = 0;
+            size_t got = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+            end += got;
+            eof = got == 0;
+        }
+    }
+
+    static bool parseField(const char*& s, const char* last, int& value) {
+        while (s < last && (*s == ' ' || *s == '\t')) s++;
+        auto [ptr, ec] = std::from_chars(s, last, value);
+        if (ec != std::errc()) return false;
+        s = ptr;
+        while (s < last && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+        return true;
+    }
+
+public:
+    std::string error;
+
+    explicit CSVWorkloadReader(const std::string& path) : file(std::fopen(path.c_str(), "rb")) {
+        if (!file) error = "cannot open file";
+    }
+    ~CSVWorkloadReader() {
+        if (file) std::fclose(file);
+    }
+    CSVWorkloadReader(const CSVWorkloadReader&) = delete;
+    CSVWorkloadReader& operator=(const CSVWorkloadReader&) = delete;
+
+    bool next(Process& p) {
+        if (!error.empty()) return false;
+        const char* first;
+        const char* last;
+        while (nextLine(first, last)) {
+            const char* s = first;
+            while (s < last && std::isspace(static_cast<unsigned char>(*s))) s++;
+            if (s == last || *s == '#') continue;
+            bool header = headerAllowed && !std::isdigit(static_cast<unsigned char>(*s)) && *s != '-';
+            headerAllowed = false;
+            if (header) continue;
+
+            int fields[4];
+            bool valid = true;
+            for (int f = 0; f < 4 && valid; ++f) {
+                valid = parseField(s, last, fields[f]) && (f == 3 ? s == last : s < last && *s++ == ',');
+            }
+            if (valid) {
+                p = Process{fields[0], fields[1], fields[2], fields[3], fields[2]};
+                error = checkWorkloadRecord(p, lastArrival, horizon);
+            } else {
+                error = "expected id,arrival,burst,priority";
+            }
+            if (!error.empty()) {
+                error = "line " + std::to_string(line) + ": " + error;
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// Maps a binary workload and decodes it front to back, dropping the pages
+// already read every 16 MB so the resident set stays small however long
+// the file is
+class BinaryWorkloadReader {
+private:
+    static const size_t releaseEvery = 16 << 20;
+
+    unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t offset = sizeof(binaryWorkloadMagic);
+    size_t released = 0;
+    long long record = 0;
+    long long previousId = 0;
+    int lastArrival = 0;
+    long long horizon = 0;
+
+    bool varint(unsigned long long& value) {
+        value = 0;
+        for (int shift = 0; offset < size && shift < 64; shift += 7) {
+            unsigned char byte = data[offset++];
+            value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static long long unzigzag(unsigned long long v) {
+        return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1);
+    }
+
+public:
+    std::string error;
+
+    explicit BinaryWorkloadReader(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open file";
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = info.st_size;
+            void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                error = "cannot map file";
+                size = 0;
+            } else {
+                data = static_cast<unsigned char*>(map);
+                madvise(data, size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        if (error.empty() &&
+            (size < sizeof(binaryWorkloadMagic) || std::memcmp(data, binaryWorkloadMagic, sizeof(binaryWorkloadMagic)) != 0)) {
+            error = "not a binary workload";
+        }
+    }
+    ~BinaryWorkloadReader() {
+        if (data) munmap(data, size);
+    }
+    BinaryWorkloadReader(const BinaryWorkloadReader&) = delete;
+    BinaryWorkloadReader& operator=(const BinaryWorkloadReader&) = delete;
+
+    bool next(Process& p) {
+        if (!error.empty() || offset >= size) return false;
+        record++;
+        unsigned long long idChange, gap, burst, priority;
+        if (!varint(idChange) || !varint(gap) || !varint(burst) || !varint(priority)) {
+            error = "truncated";
+        } else if (lastArrival + gap > INT_MAX || burst > INT_MAX) {
+            error = "time out of range";
+        } else {
+            previousId += unzigzag(idChange);
+            p = Process{static_cast<int>(previousId), static_cast<int>(lastArrival + gap), static_cast<int>(burst),
+                        static_cast<int>(unzigzag(priority)), static_cast<int>(burst)};
+            error = checkWorkloadRecord(p, lastArrival, horizon);
+        }
+        if (!error.empty()) {
+            error = "record " + std::to_string(record) + ": " + error;
+            return false;
+        }
+        if (offset - released >= releaseEvery) {
+            size_t upTo = offset / releaseEvery * releaseEvery;
+            madvise(data + released, upTo - released, MADV_DONTNEED);
+            released = upTo;
+        }
+        return true;
+    }
+};
+
+// Buffered output of workloads (CSV or binary) and of streamed results
+// (CSV); "-" is standard output
+class RecordWriter {
+private:
+    std::FILE* file;
+    std::vector<char> buffer = std::vector<char>(1 << 20);
+    size_t used = 0;
+    long long previousId = 0;
+    long long previousArrival = 0;
+
+    void varint(unsigned long long value) {
+        while (value >= 0x80) {
+            buffer[used++] = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        buffer[used++] = static_cast<char>(value);
+    }
+
+    static unsigned long long zigzag(long long v) {
+        return (static_cast<unsigned long long>(v) << 1) ^ static_cast<unsigned long long>(v >> 63);
+    }
+
+    void reserve(size_t bytes) {
+        if (used + bytes > buffer.size()) flush();
+    }
+
+public:
+    explicit RecordWriter(const std::string& path)
+        : file(path == "-" ? stdout : std::fopen(path.c_str(), "wb")) {}
+    ~RecordWriter() {
+        flush();
+        if (file && file != stdout) std::fclose(file);
+    }
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    bool ok() const {
+        return file != nullptr;
+    }
+
+    void flush() {
+        if (file && used) std::fwrite(buffer.data(), 1, used, file);
+        used = 0;
+    }
+
+    void text(const std::string& s) {
+        reserve(s.size());
+        std::memcpy(buffer.data() + used, s.data(), s.size());
+        used += s.size();
+    }
+
+    void row(std::initializer_list<long long> fields) {
+        reserve(fields.size() * 21);
+        char* out = buffer.data() + used;
+        for (long long field : fields) {
+            out = std::to_chars(out, buffer.data() + buffer.size(), field).ptr;
+            *out++ = ',';
+        }
+        out[-1] = '\n';
+        used = out - buffer.data();
+    }
+
+    // Processes must come in arrival order
+    void binary(const Process& p) {
+        reserve(4 * 10);
+        varint(zigzag(p.id - previousId));
+        varint(p.arrivalTime - previousArrival);
+        varint(p.burstTime);
+        varint(zigzag(p.priority));
+        previousId = p.id;
+        previousArrival = p.arrivalTime;
+    }
+};
+
+bool parseDistribution(const std::string& name, BurstDistribution& distribution) {
+    if (name == "exponential") {
+        distribution = BurstDistribution::Exponential;
+    } else if (name == "heavy-tailed") {
+        distribution = BurstDistribution::HeavyTailed;
+    } else if (name == "bimodal") {
+        distribution = BurstDistribution::Bimodal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Writes a generated workload to --out, one process at a time, so traces
+// of any length can be produced for replay
+int writeWorkload(int argc, char* argv[]) {
+    std::string path = optionValue(argc, argv, "--out", "");
+    std::string format = optionValue(argc, argv, "--format", "csv");
+    WorkloadConfig config;
+    config.processes = std::stoi(optionValue(argc, argv, "--processes", "1000000"));
+    config.seed = std::stoul(optionValue(argc, argv, "--seed", "1"));
+    std::string distribution = optionValue(argc, argv, "--workload", "exponential");
+    if (!parseDistribution(distribution, config.burst)) {
+        std::cerr << "Error: unknown burst distribution " << distribution << "\n";
+        return 1;
+    }
+    if (path.empty() || (format != "csv" && format != "binary")) {
+        std::cerr << "Error: write-workload needs --out=path and --format=csv|binary\n";
+        return 1;
+    }
+    RecordWriter writer(path);
+    if (!writer.ok()) {
+        std::cerr << "Error: cannot write " << path << "\n";
+        return 1;
+    }
+    if (format == "binary") {
+        writer.text(std::string(binaryWorkloadMagic, sizeof(binaryWorkloadMagic)));
+    } else {
+        writer.text("id,arrival,burst,priority\n");
+    }
+    WorkloadStream stream(config);
+    Process p;
+    while (stream.next(p)) {
+        if (format == "binary") {
+            writer.binary(p);
+        } else {
+            writer.row({p.id, p.arrivalTime, p.burstTime, p.priority});
+        }
+    }
+    return 0;
+}
+
+// Replays a recorded workload (--trace, CSV or binary) or a generated one
+// through a policy as a stream. Completed processes go to --out as CSV in
+// completion order; averages and percentiles are kept on the fly, so
+// nothing grows with the length of the trace.
+int replayWorkload(int argc, char* argv[]) {
+    std::string path = optionValue(argc, argv, "--trace", "");
+    std::string policy = optionValue(argc, argv, "--policy", "FCFS");
+    std::string outPath = optionValue(argc, argv, "--out", "");
+    Algorithm algorithm;
+    if (!parseAlgorithm(policy, algorithm)) {
+        std::cerr << "Error: unknown policy " << policy << "\n";
+        return 1;
+    }
+    std::unique_ptr<RecordWriter> writer;
+    if (!outPath.empty()) {
+        writer = std::make_unique<RecordWriter>(outPath);
+        if (!writer->ok()) {
+            std::cerr << "Error: cannot write " << outPath << "\n";
+            return 1;
+        }
+        writer->text("id,arrival,burst,priority,completion,turnaround,waiting\n");
+    }
+
+    TableMetrics metrics;
+    long long count = 0, turnaroundSum = 0, waitingSum = 0;
+    auto retire = [&](const ProcessTable& table, int i) {
+        int turnaround = table.completion[i] - table.arrival[i];
+        int waiting = turnaround - table.burst[i];
+        count++;
+        turnaroundSum += turnaround;
+        waitingSum += waiting;
+        metrics.turnaround.add(turnaround);
+        metrics.waiting.add(waiting);
+        if (writer) {
+            writer->row({table.id[i], table.arrival[i], table.burst[i], table.priority[i], table.completion[i], turnaround, waiting});
+        }
+    };
+
+    ProcessTable table;
+    long long switches = 0;
+    std::string error;
+    long long before = heapBytes;
+    heapPeak = before;
+    auto start = std::chrono::steady_clock::now();
+    if (path.empty()) {
+        WorkloadConfig config;
+        config.processes = std::stoi(optionValue(argc, argv, "--processes", "1000000"));
+        std::string distribution = optionValue(argc, argv, "--workload", "exponential");
+        if (!parseDistribution(distribution, config.burst)) {
+            std::cerr << "Error: unknown burst distribution " << distribution << "\n";
+            return 1;
+        }
+        WorkloadStream stream(config);
+        switches = simulateStream(algorithm, stream, retire, table);
+    } else if (isBinaryWorkload(path)) {
+        BinaryWorkloadReader reader(path);
+        if (reader.error.empty()) switches = simulateStream(algorithm, reader, retire, table);
+        error = reader.error;
+    } else {
+        CSVWorkloadReader reader(path);
+        if (reader.error.empty()) switches = simulateStream(algorithm, reader, retire, table);
+        error = reader.error;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (writer) writer->flush();
+    if (!error.empty()) {
+        std::cerr << "Error: " << path << ": " << error << "\n";
+        return 1;
+    }
+
+    metrics.avgTurnaround = count ? static_cast<double>(turnaroundSum) / count : 0;
+    metrics.avgWaiting = count ? static_cast<double>(waitingSum) / count : 0;
+    // With --out=- the records own stdout, so the summary goes to stderr
+    std::ostream& report = outPath == "-" ? std::cerr : std::cout;
+    report << "\n--- " << algorithmName(algorithm) << ", streamed ---\n";
+    printMetrics(metrics, report);
+    report << "Replayed " << count << " processes in " << elapsed.count() * 1000 << " ms (" << count / elapsed.count()
+           << " processes/s), " << switches << " context switches\n";
+    // The table only grows, so its final size is its peak
+    double peakMB = (heapPeak - before + static_cast<double>(table.capacityBytes())) / (1024.0 * 1024.0);
+    report << "Peak table slots (live processes): " << table.size() << ", peak heap: " << peakMB << " MB\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "verify") {
+        int rounds = argc > 2 ? std::stoi(argv[2]) : 20000;
+        if (verifyEventEngine(rounds) != 0) return 1;
+        return verifySingleCPU(rounds);
+    }
+    if (mode == "bench") {
+        int maxProcesses = argc > 2 ? std::stoi(argv[2]) : 10000000;
+        return benchmarkSchedulers(maxProcesses, argc > 3 ? argv[3] : "");
+    }
+    if (mode == "sweep") {
+        return runSweep(argc, argv);
+    }
+    if (mode == "smp") {
+        return runSMP(argc, argv);
+    }
+    if (mode == "run") {
+        return runWorkload(argc, argv);
+    }
+    if (mode == "trace") {
+        return runTrace(argc, argv);
+    }
+    if (mode == "real") {
+        return runReal(argc, argv);
+    }
+    if (mode == "write-workload") {
+        return writeWorkload(argc, argv);
+    }
+    if (mode == "replay") {
+        return replayWorkload(argc, argv);
+    }
+    if (!mode.empty()) {
+        std::cerr << "Usage: scheduler [verify [rounds] | bench [max processes] [exponential|heavy-tailed|bimodal]\n"
+                  << "                  | sweep [--processes=N] [--seeds=N] [--workloads=a,b] [--policies=a,b]\n"
+                  << "                          [--rr=R] [--mlq-system=R] [--mlq-interactive=R] [--mlfq-top=R]\n"
+                  << "                          [--mlfq-middle=R] [--aging=R] [--cfs-latency=R] [--eevdf-slice=R]\n"
+                  << "                          [--stride=R] [--threads=N] [--csv=path]\n"
+                  << "                  | smp [--cpus=N] [--policy=FCFS|SRTF|RR|MLQ|MLFQ] [--quantum=N]\n"
+                  << "                        [--queue=per-core|global] [--no-steal] [--migration-cost=N]\n"
+                  << "                        [--pinned=F] [--processes=N] [--load=F] [--workload=D] [--compare]\n"
+                  << "                  | run [--processes=N] [--workload=D] [--policies=a,b] [--table]\n"
+                  << "                  | trace [--processes=N] [--policy=P] [--capacity=N] [--out=path]\n"
+                  << "                  | real [--threads=N] [--policy=RR|SRTF|MLFQ] [--processes=N] [--load=F]\n"
+                  << "                         [--unit-us=N] [--table]\n"
+                  << "                  | write-workload --out=path [--format=csv|binary] [--processes=N] [--workload=D]\n"
+                  << "                                   [--seed=N]\n"
+                  << "                  | replay [--trace=path] [--policy=P] [--out=path|-] [--processes=N] [--workload=D]]\n"
+                  << "  where R is a list a,b,c or a range start:end[:step]\n";
+        return 1;
+    }
 
-int main() {
     // Sample processes {id, arrival, burst, priority}
     // For MLQ -> Prio 1: System, Prio 2: Interactive, Prio 3: Batch
      std::vector<Process> processes = {